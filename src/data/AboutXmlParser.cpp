@@ -0,0 +1,309 @@
+#include "AboutXmlParser.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <string_view>
+
+namespace
+{
+    using Element = AboutXmlParser::Element;
+
+    struct ElementEntry
+    {
+        std::u16string_view name;
+        Element element;
+    };
+
+    // 按 UTF-16 码元排序，供二分查找使用
+    constexpr ElementEntry ELEMENT_TABLE[] = {
+        {u"author", Element::Author},
+        {u"authors", Element::Authors},
+        {u"description", Element::Description},
+        {u"forceLoadAfter", Element::ForceLoadAfter},
+        {u"forceLoadBefore", Element::ForceLoadBefore},
+        {u"incompatibleWith", Element::IncompatibleWith},
+        {u"incompatibleWithByVersion", Element::IncompatibleWithByVersion},
+        {u"loadAfter", Element::LoadAfter},
+        {u"loadAfterByVersion", Element::LoadAfterByVersion},
+        {u"loadBefore", Element::LoadBefore},
+        {u"loadBeforeByVersion", Element::LoadBeforeByVersion},
+        {u"modDependencies", Element::ModDependencies},
+        {u"modDependenciesByVersion", Element::ModDependenciesByVersion},
+        {u"name", Element::Name},
+        {u"packageId", Element::PackageId},
+        {u"steamAppId", Element::SteamAppId},
+        {u"supportedVersions", Element::SupportedVersions},
+        {u"url", Element::Url},
+    };
+
+    constexpr bool entryLess(const ElementEntry &a, const ElementEntry &b)
+    {
+        return a.name < b.name;
+    }
+
+    static_assert(std::is_sorted(std::begin(ELEMENT_TABLE), std::end(ELEMENT_TABLE), entryLess),
+                  "ELEMENT_TABLE must be sorted for binary search");
+
+    inline std::u16string_view toU16View(QStringView view)
+    {
+        return std::u16string_view(reinterpret_cast<const char16_t *>(view.utf16()), size_t(view.size()));
+    }
+
+    void appendUnique(QStringList &list, const QString &item)
+    {
+        if (!item.isEmpty() && !list.contains(item))
+        {
+            list.append(item);
+        }
+    }
+
+    // 版本块元素名（v1.5）转换为 major.minor 键，不是版本块时返回空
+    QString versionKey(QStringView elementName)
+    {
+        if (!elementName.startsWith(u'v'))
+        {
+            return QString();
+        }
+        return ModItem::toMajorMinorVersion(elementName.toString());
+    }
+}
+
+AboutXmlParser::Element AboutXmlParser::lookupElement(QStringView name)
+{
+    const std::u16string_view key = toU16View(name);
+    const auto *it = std::lower_bound(std::begin(ELEMENT_TABLE), std::end(ELEMENT_TABLE), key,
+                                      [](const ElementEntry &entry, std::u16string_view value)
+                                      { return entry.name < value; });
+    if (it != std::end(ELEMENT_TABLE) && it->name == key)
+    {
+        return it->element;
+    }
+    return Element::Unknown;
+}
+
+bool AboutXmlParser::parseFile(ModItem *mod, const QString &aboutXmlPath, const std::atomic<bool> *cancelFlag)
+{
+    MappedFile file(aboutXmlPath);
+    if (!file.open())
+    {
+        return false;
+    }
+
+    return parse(mod, file.data(), cancelFlag);
+}
+
+bool AboutXmlParser::parse(ModItem *mod, const QByteArray &data, const std::atomic<bool> *cancelFlag)
+{
+    QXmlStreamReader xml(data);
+
+    // 定位根元素 ModMetaData
+    if (!xml.readNextStartElement())
+    {
+        return false;
+    }
+
+    // 只处理根元素的直接子元素，每个分支都必须读到对应的结束标签
+    while (xml.readNextStartElement())
+    {
+        // 超长的描述或依赖列表在慢速磁盘上可能读取很久，每个顶层元素之间检查一次取消
+        if (cancelFlag && cancelFlag->load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        switch (lookupElement(xml.name()))
+        {
+        case Element::Name:
+            mod->name = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+            break;
+        case Element::Author:
+            mod->author = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+            break;
+        case Element::Authors:
+            mod->author = readAuthors(xml);
+            break;
+        case Element::Description:
+            mod->setDescription(xml.readElementText(QXmlStreamReader::IncludeChildElements));
+            break;
+        case Element::PackageId:
+        {
+            const QString packageId = xml.readElementText().trimmed();
+            mod->packageId = packageId;
+            mod->identifier = packageId;
+            break;
+        }
+        case Element::SteamAppId:
+            mod->steamId = xml.readElementText().trimmed();
+            break;
+        case Element::Url:
+            mod->url = xml.readElementText().trimmed();
+            break;
+        case Element::SupportedVersions:
+            readTextList(xml, mod->supportedVersions);
+            break;
+        case Element::ModDependencies:
+            readDependencyList(xml, mod->versionedDependencies.base);
+            break;
+        case Element::ModDependenciesByVersion:
+            readVersionedDependencyList(xml, mod->versionedDependencies);
+            break;
+        case Element::LoadBefore:
+            readTextList(xml, mod->versionedLoadBefore.base);
+            break;
+        case Element::LoadAfter:
+            readTextList(xml, mod->versionedLoadAfter.base);
+            break;
+        case Element::LoadBeforeByVersion:
+            readVersionedTextList(xml, mod->versionedLoadBefore);
+            break;
+        case Element::LoadAfterByVersion:
+            readVersionedTextList(xml, mod->versionedLoadAfter);
+            break;
+        case Element::ForceLoadBefore:
+            readTextList(xml, mod->forceLoadBefore);
+            break;
+        case Element::ForceLoadAfter:
+            readTextList(xml, mod->forceLoadAfter);
+            break;
+        case Element::IncompatibleWith:
+            readTextList(xml, mod->versionedIncompatibleWith.base);
+            break;
+        case Element::IncompatibleWithByVersion:
+            readVersionedTextList(xml, mod->versionedIncompatibleWith);
+            break;
+        case Element::Unknown:
+            xml.skipCurrentElement();
+            break;
+        }
+    }
+
+    // 先按所有版本的并集生成生效列表，由ModManager按目标游戏版本重新选择
+    mod->applyGameVersion(QString());
+
+    return !xml.hasError() && mod->isValid();
+}
+
+void AboutXmlParser::readTextList(QXmlStreamReader &xml, QStringList &out)
+{
+    while (xml.readNextStartElement())
+    {
+        if (xml.name() == u"li")
+        {
+            appendUnique(out, xml.readElementText(QXmlStreamReader::SkipChildElements).trimmed());
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+void AboutXmlParser::readVersionedTextList(QXmlStreamReader &xml, VersionedList &out)
+{
+    // 每个版本块（如 v1.4、v1.5）单独保存，键为 major.minor
+    while (xml.readNextStartElement())
+    {
+        const QString version = versionKey(xml.name());
+        if (!version.isEmpty())
+        {
+            readTextList(xml, out.byVersion[version]);
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+void AboutXmlParser::readDependencyList(QXmlStreamReader &xml, QStringList &out)
+{
+    while (xml.readNextStartElement())
+    {
+        if (xml.name() == u"li")
+        {
+            appendUnique(out, readDependencyItem(xml));
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+void AboutXmlParser::readVersionedDependencyList(QXmlStreamReader &xml, VersionedList &out)
+{
+    while (xml.readNextStartElement())
+    {
+        const QString version = versionKey(xml.name());
+        if (!version.isEmpty())
+        {
+            readDependencyList(xml, out.byVersion[version]);
+        }
+        else
+        {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+QString AboutXmlParser::readDependencyItem(QXmlStreamReader &xml)
+{
+    QString packageId;
+
+    // <li> 的内容可能是直接的文本（旧格式）或包含 <packageId> 子元素
+    while (!xml.atEnd())
+    {
+        QXmlStreamReader::TokenType token = xml.readNext();
+
+        if (token == QXmlStreamReader::StartElement)
+        {
+            if (xml.name() == u"packageId")
+            {
+                packageId = xml.readElementText().trimmed();
+            }
+            else
+            {
+                xml.skipCurrentElement();
+            }
+        }
+        else if (token == QXmlStreamReader::Characters && packageId.isEmpty() && !xml.isWhitespace())
+        {
+            packageId = xml.text().trimmed().toString();
+        }
+        else if (token == QXmlStreamReader::EndElement)
+        {
+            break; // </li>
+        }
+    }
+
+    return packageId;
+}
+
+QString AboutXmlParser::readAuthors(QXmlStreamReader &xml)
+{
+    QStringList authors;
+
+    // <authors> 可以是 <li> 列表，也可以直接是文本
+    while (!xml.atEnd())
+    {
+        QXmlStreamReader::TokenType token = xml.readNext();
+
+        if (token == QXmlStreamReader::StartElement)
+        {
+            const QString author = xml.readElementText(QXmlStreamReader::SkipChildElements).trimmed();
+            if (!author.isEmpty())
+            {
+                authors.append(author);
+            }
+        }
+        else if (token == QXmlStreamReader::Characters && !xml.isWhitespace())
+        {
+            authors.append(xml.text().trimmed().toString());
+        }
+        else if (token == QXmlStreamReader::EndElement)
+        {
+            break; // </authors>
+        }
+    }
+
+    return authors.join(", ");
+}
@@ -0,0 +1,74 @@
+#ifndef ABOUTXMLPARSER_H
+#define ABOUTXMLPARSER_H
+
+#include "ModItem.h"
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+#include <QXmlStreamReader>
+#include <atomic>
+
+/**
+ * @brief About.xml 解析器（WorkshopScanner 和 OfficialDLCScanner 共用）
+ *
+ * 只处理 ModMetaData 的直接子元素。元素名通过编译期排序的常量表匹配，
+ * 直接比较 xml.name() 返回的 QStringView，解析过程中不会为元素名分配字符串。
+ */
+class AboutXmlParser
+{
+public:
+    // 解析About.xml内容，成功且packageId有效时返回true
+    // cancelFlag不为空时在每个顶层元素之间检查，被取消时返回false
+    static bool parse(ModItem *mod, const QByteArray &data, const std::atomic<bool> *cancelFlag = nullptr);
+
+    // 读取并解析About.xml文件（按 MappedFile 的开关决定是否内存映射）
+    static bool parseFile(ModItem *mod, const QString &aboutXmlPath, const std::atomic<bool> *cancelFlag = nullptr);
+
+    // 已知的 ModMetaData 子元素
+    enum class Element
+    {
+        Unknown,
+        Name,
+        Author,
+        Authors,
+        Description,
+        PackageId,
+        SteamAppId,
+        Url,
+        SupportedVersions,
+        ModDependencies,
+        ModDependenciesByVersion,
+        LoadBefore,
+        LoadAfter,
+        LoadBeforeByVersion,
+        LoadAfterByVersion,
+        ForceLoadBefore,
+        ForceLoadAfter,
+        IncompatibleWith,
+        IncompatibleWithByVersion
+    };
+
+    // 查找元素名对应的枚举值（二分查找常量表，无内存分配）
+    static Element lookupElement(QStringView name);
+
+private:
+    // 读取 <li> 列表中的文本项（去重追加到out）
+    static void readTextList(QXmlStreamReader &xml, QStringList &out);
+
+    // 读取 <v1.x> 版本块中的文本项，按版本分别保存
+    static void readVersionedTextList(QXmlStreamReader &xml, VersionedList &out);
+
+    // 读取依赖列表（<li> 可以是文本或包含 <packageId>）
+    static void readDependencyList(QXmlStreamReader &xml, QStringList &out);
+
+    // 读取 <v1.x> 版本块中的依赖列表，按版本分别保存
+    static void readVersionedDependencyList(QXmlStreamReader &xml, VersionedList &out);
+
+    // 读取单个依赖项，返回packageId
+    static QString readDependencyItem(QXmlStreamReader &xml);
+
+    // 读取作者列表（<authors><li>..</li></authors>），以逗号连接
+    static QString readAuthors(QXmlStreamReader &xml);
+};
+
+#endif // ABOUTXMLPARSER_H
@@ -0,0 +1,263 @@
+#include "ActiveModList.h"
+
+ActiveModList::ActiveModList()
+    : m_random(0x9E3779B9u)
+{
+}
+
+void ActiveModList::clear()
+{
+    m_nodes.clear();
+    m_freeNodes.clear();
+    m_nodeOf.clear();
+    setRoot(-1);
+}
+
+int ActiveModList::assign(const QStringList &packageIds)
+{
+    clear();
+    m_nodes.reserve(packageIds.size());
+    m_nodeOf.reserve(packageIds.size());
+
+    int dropped = 0;
+    for (const QString &packageId : packageIds)
+    {
+        if (!append(packageId))
+        {
+            ++dropped;
+        }
+    }
+    return dropped;
+}
+
+int ActiveModList::indexOf(const QString &packageId) const
+{
+    const int node = m_nodeOf.value(keyOf(packageId), -1);
+    return node < 0 ? -1 : positionOfNode(node);
+}
+
+QString ActiveModList::at(int position) const
+{
+    int node = m_root;
+    while (node >= 0)
+    {
+        const int leftSize = sizeOf(m_nodes[node].left);
+        if (position < leftSize)
+        {
+            node = m_nodes[node].left;
+        }
+        else if (position == leftSize)
+        {
+            return m_nodes[node].packageId;
+        }
+        else
+        {
+            position -= leftSize + 1;
+            node = m_nodes[node].right;
+        }
+    }
+    return QString();
+}
+
+bool ActiveModList::insert(int position, const QString &packageId)
+{
+    const QString key = keyOf(packageId);
+    if (packageId.isEmpty() || m_nodeOf.contains(key))
+    {
+        return false;
+    }
+
+    int node;
+    if (!m_freeNodes.isEmpty())
+    {
+        node = m_freeNodes.takeLast();
+    }
+    else
+    {
+        node = int(m_nodes.size());
+        m_nodes.append(Node());
+    }
+    m_nodes[node].packageId = packageId;
+    m_nodes[node].priority = m_random.generate();
+    m_nodeOf.insert(key, node);
+
+    if (position < 0 || position > size())
+    {
+        position = size();
+    }
+    attach(node, position);
+    return true;
+}
+
+bool ActiveModList::remove(const QString &packageId)
+{
+    const auto it = m_nodeOf.constFind(keyOf(packageId));
+    if (it == m_nodeOf.constEnd())
+    {
+        return false;
+    }
+
+    const int node = it.value();
+    m_nodeOf.erase(it);
+    detach(node);
+    m_nodes[node].packageId.clear();
+    m_freeNodes.append(node);
+    return true;
+}
+
+bool ActiveModList::move(const QString &packageId, int newPosition)
+{
+    const int node = m_nodeOf.value(keyOf(packageId), -1);
+    if (node < 0 || newPosition < 0 || newPosition >= size())
+    {
+        return false;
+    }
+
+    // 摘下后再插入，移动后正好位于newPosition
+    detach(node);
+    attach(node, newPosition);
+    return true;
+}
+
+const QStringList &ActiveModList::toStringList() const
+{
+    if (!m_viewDirty)
+    {
+        return m_view;
+    }
+
+    // 中序遍历（显式栈）
+    m_view.clear();
+    m_view.reserve(size());
+    QList<int> stack;
+    int node = m_root;
+    while (node >= 0 || !stack.isEmpty())
+    {
+        while (node >= 0)
+        {
+            stack.append(node);
+            node = m_nodes[node].left;
+        }
+        node = stack.takeLast();
+        m_view.append(m_nodes[node].packageId);
+        node = m_nodes[node].right;
+    }
+    m_viewDirty = false;
+    return m_view;
+}
+
+void ActiveModList::update(int node)
+{
+    Node &n = m_nodes[node];
+    n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+    if (n.left >= 0)
+    {
+        m_nodes[n.left].parent = node;
+    }
+    if (n.right >= 0)
+    {
+        m_nodes[n.right].parent = node;
+    }
+}
+
+void ActiveModList::split(int node, int count, int &left, int &right)
+{
+    if (node < 0)
+    {
+        left = right = -1;
+        return;
+    }
+
+    int lower;
+    int upper;
+    if (count <= sizeOf(m_nodes[node].left))
+    {
+        split(m_nodes[node].left, count, lower, upper);
+        m_nodes[node].left = upper;
+        left = lower;
+        right = node;
+    }
+    else
+    {
+        split(m_nodes[node].right, count - sizeOf(m_nodes[node].left) - 1, lower, upper);
+        m_nodes[node].right = lower;
+        left = node;
+        right = upper;
+    }
+    update(node);
+}
+
+int ActiveModList::merge(int left, int right)
+{
+    if (left < 0)
+    {
+        return right;
+    }
+    if (right < 0)
+    {
+        return left;
+    }
+
+    // 优先级大的节点在上
+    if (m_nodes[left].priority > m_nodes[right].priority)
+    {
+        const int merged = merge(m_nodes[left].right, right);
+        m_nodes[left].right = merged;
+        update(left);
+        return left;
+    }
+
+    const int merged = merge(left, m_nodes[right].left);
+    m_nodes[right].left = merged;
+    update(right);
+    return right;
+}
+
+int ActiveModList::positionOfNode(int node) const
+{
+    // 左子树的节点都在前面；每次从右子节点回到父节点，父节点及其左子树也在前面
+    int position = sizeOf(m_nodes[node].left);
+    for (int parent = m_nodes[node].parent; parent >= 0; node = parent, parent = m_nodes[node].parent)
+    {
+        if (m_nodes[parent].right == node)
+        {
+            position += sizeOf(m_nodes[parent].left) + 1;
+        }
+    }
+    return position;
+}
+
+void ActiveModList::attach(int node, int position)
+{
+    Node &n = m_nodes[node];
+    n.left = n.right = n.parent = -1;
+    n.size = 1;
+
+    int left;
+    int right;
+    split(m_root, position, left, right);
+    setRoot(merge(merge(left, node), right));
+}
+
+void ActiveModList::detach(int node)
+{
+    const int position = positionOfNode(node);
+
+    int left;
+    int rest;
+    int middle;
+    int right;
+    split(m_root, position, left, rest);
+    split(rest, 1, middle, right);
+    setRoot(merge(left, right));
+}
+
+void ActiveModList::setRoot(int root)
+{
+    m_root = root;
+    if (m_root >= 0)
+    {
+        m_nodes[m_root].parent = -1;
+    }
+    m_viewDirty = true;
+}
@@ -0,0 +1,98 @@
+#ifndef ACTIVEMODLIST_H
+#define ACTIVEMODLIST_H
+
+#include <QHash>
+#include <QList>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief 激活Mod列表（按加载顺序，PackageId不区分大小写且不重复）
+ *
+ * 以隐式 treap 保存顺序（每个节点记录子树大小），并用哈希表把小写 PackageId 映射到节点：
+ * - 查找、判断是否激活：O(1)
+ * - 位置查询、插入、删除、移动：期望 O(log n)（节点保存父节点，从节点向上累加即可得到位置）
+ * toStringList() 返回按需重建的只读视图，修改后第一次读取时为 O(n)，之后直接返回缓存。
+ */
+class ActiveModList
+{
+public:
+    ActiveModList();
+
+    // 清空列表
+    void clear();
+
+    // 按顺序替换整个列表，返回被丢弃的重复项数量（大小写不同也视为重复，保留第一次出现的）
+    int assign(const QStringList &packageIds);
+
+    int size() const { return sizeOf(m_root); }
+    bool isEmpty() const { return m_root < 0; }
+
+    // 是否包含packageId（不区分大小写）
+    bool contains(const QString &packageId) const { return m_nodeOf.contains(keyOf(packageId)); }
+
+    // packageId的位置，不存在时返回-1
+    int indexOf(const QString &packageId) const;
+
+    // 指定位置的PackageId（保持原始大小写）
+    QString at(int position) const;
+
+    // 插入到指定位置（超出范围时追加到末尾），已存在时返回false
+    bool insert(int position, const QString &packageId);
+    bool append(const QString &packageId) { return insert(size(), packageId); }
+
+    // 删除packageId，不存在时返回false
+    bool remove(const QString &packageId);
+
+    // 把packageId移动到newPosition（与 QList::move 相同，移动后位于newPosition）
+    bool move(const QString &packageId, int newPosition);
+
+    // 按加载顺序排列的只读视图
+    const QStringList &toStringList() const;
+
+private:
+    struct Node
+    {
+        QString packageId;
+        quint32 priority = 0;
+        int left = -1;
+        int right = -1;
+        int parent = -1;
+        int size = 1;
+    };
+
+    static QString keyOf(const QString &packageId) { return packageId.toLower(); }
+
+    int sizeOf(int node) const { return node < 0 ? 0 : m_nodes[node].size; }
+
+    // 重新计算子树大小，并把子节点的父节点指向node
+    void update(int node);
+
+    // 把子树按前count个节点拆分为left和right
+    void split(int node, int count, int &left, int &right);
+
+    // 合并两棵子树（left中的节点全部在right之前），返回新的根
+    int merge(int left, int right);
+
+    // 节点在整个列表中的位置
+    int positionOfNode(int node) const;
+
+    // 把游离的节点挂到指定位置 / 把节点从树中摘下（节点保留在m_nodes中）
+    void attach(int node, int position);
+    void detach(int node);
+
+    // 更新根节点并标记视图过期
+    void setRoot(int root);
+
+    QList<Node> m_nodes;        // 节点池（下标即节点编号）
+    QList<int> m_freeNodes;     // 已删除、可复用的节点
+    QHash<QString, int> m_nodeOf; // 小写PackageId到节点
+    int m_root = -1;
+    QRandomGenerator m_random;  // 节点优先级（固定种子，结果可复现）
+
+    mutable QStringList m_view; // 按顺序排列的缓存视图
+    mutable bool m_viewDirty = false;
+};
+
+#endif // ACTIVEMODLIST_H
@@ -0,0 +1,334 @@
+#include "ActiveOrderIndex.h"
+#include "ModManager.h"
+
+void ActiveOrderIndex::reset(const QStringList &activeMods, ModManager *manager)
+{
+    m_manager = manager;
+    m_order.clear();
+    m_positions.clear();
+    m_status.clear();
+    m_referencedBy.clear();
+
+    m_order.reserve(activeMods.size());
+    for (const QString &packageId : activeMods)
+    {
+        m_order.append(m_manager->internPackageId(packageId));
+    }
+
+    ensureIdCapacity(quint32(m_manager->getModIdCount()) - 1);
+    for (int i = 0; i < m_order.size(); ++i)
+    {
+        // 重复项按第一次出现的位置计算
+        if (m_positions[m_order[i]] == -1)
+        {
+            m_positions[m_order[i]] = i;
+            if (const ModItem *mod = modAt(i))
+            {
+                linkReferences(mod);
+            }
+        }
+    }
+
+    for (quint32 id : m_order)
+    {
+        recomputeStatus(id);
+    }
+}
+
+ModItem *ActiveOrderIndex::modAt(int position) const
+{
+    return m_manager ? m_manager->findModById(m_order.at(position)) : nullptr;
+}
+
+int ActiveOrderIndex::positionOf(quint32 id) const
+{
+    return id < quint32(m_positions.size()) ? m_positions[id] : -1;
+}
+
+int ActiveOrderIndex::positionOf(const QString &packageId) const
+{
+    return m_manager ? positionOf(m_manager->findModId(packageId)) : -1;
+}
+
+const ActiveOrderIndex::ModStatus &ActiveOrderIndex::statusOf(quint32 id) const
+{
+    static const ModStatus empty;
+    return id < quint32(m_status.size()) ? m_status[id] : empty;
+}
+
+int ActiveOrderIndex::issueCount() const
+{
+    int count = 0;
+    for (int i = 0; i < m_order.size(); ++i)
+    {
+        // 重复项只计算一次
+        if (m_positions[m_order[i]] == i && !m_status[m_order[i]].isOk())
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+QList<QPair<quint32, quint32>> ActiveOrderIndex::conflictPairs() const
+{
+    // 每对冲突在较小的ID处报告一次，代价为 O(n + 冲突数)
+    QList<QPair<quint32, quint32>> pairs;
+    for (int i = 0; i < m_order.size(); ++i)
+    {
+        const quint32 id = m_order[i];
+        if (m_positions[id] != i)
+        {
+            continue; // 重复项
+        }
+        for (quint32 other : m_manager->getConflictIds(id))
+        {
+            if (id < other && contains(other))
+            {
+                pairs.append({id, other});
+            }
+        }
+    }
+    return pairs;
+}
+
+QList<quint32> ActiveOrderIndex::move(int from, int to)
+{
+    QList<quint32> changed;
+    if (from == to || from < 0 || to < 0 || from >= m_order.size() || to >= m_order.size())
+    {
+        return changed;
+    }
+
+    const quint32 id = m_order[from];
+    m_order.move(from, to);
+
+    // 只有 [first, last] 之间的Mod位置发生变化，且相对顺序只在它们与被移动的Mod之间改变
+    const int first = qMin(from, to);
+    const int last = qMax(from, to);
+    for (int p = last; p >= first; --p)
+    {
+        m_positions[m_order[p]] = p;
+    }
+
+    if (recomputeStatus(id))
+    {
+        changed.append(id);
+    }
+    recomputeReferrers(id, first, last, changed);
+    return changed;
+}
+
+QList<quint32> ActiveOrderIndex::insert(int position, const QString &packageId)
+{
+    QList<quint32> changed;
+    const quint32 id = m_manager->internPackageId(packageId);
+    ensureIdCapacity(id);
+    if (contains(id))
+    {
+        return changed;
+    }
+
+    position = qBound(0, position, int(m_order.size()));
+    m_order.insert(position, id);
+    for (int p = position; p < m_order.size(); ++p)
+    {
+        m_positions[m_order[p]] = p;
+    }
+
+    if (const ModItem *mod = modAt(position))
+    {
+        linkReferences(mod);
+    }
+
+    // 新加入的Mod可能满足其他Mod的依赖，也可能打破它们的顺序
+    if (recomputeStatus(id))
+    {
+        changed.append(id);
+    }
+    recomputeReferrers(id, 0, int(m_order.size()) - 1, changed);
+    recomputeConflicts(id, changed);
+    return changed;
+}
+
+QList<quint32> ActiveOrderIndex::remove(int position)
+{
+    QList<quint32> changed;
+    if (position < 0 || position >= m_order.size())
+    {
+        return changed;
+    }
+
+    if (const ModItem *mod = modAt(position))
+    {
+        unlinkReferences(mod);
+    }
+
+    const quint32 id = m_order.takeAt(position);
+    m_positions[id] = -1;
+    m_status[id] = ModStatus();
+    for (int p = position; p < m_order.size(); ++p)
+    {
+        m_positions[m_order[p]] = p;
+    }
+
+    recomputeReferrers(id, 0, int(m_order.size()) - 1, changed);
+    recomputeConflicts(id, changed);
+    return changed;
+}
+
+bool ActiveOrderIndex::recomputeStatus(quint32 id)
+{
+    ModStatus status;
+    const ModItem *mod = m_manager->findModById(id);
+    const int currentIndex = positionOf(id);
+
+    if (mod && currentIndex >= 0)
+    {
+        // ID列表与字符串列表按下标对应，提示信息使用原始的PackageId
+        for (int i = 0; i < mod->dependencyIds.size(); ++i)
+        {
+            if (!contains(mod->dependencyIds[i]))
+            {
+                status.missingDependencies.append(QString("[依赖] %1").arg(mod->dependencies[i]));
+            }
+        }
+        for (int i = 0; i < mod->forceLoadAfterIds.size(); ++i)
+        {
+            if (!contains(mod->forceLoadAfterIds[i]))
+            {
+                status.missingDependencies.append(QString("[强制前置] %1").arg(mod->forceLoadAfter[i]));
+            }
+        }
+
+        for (int i = 0; i < mod->loadAfterIds.size(); ++i)
+        {
+            const int afterIndex = positionOf(mod->loadAfterIds[i]);
+            if (afterIndex != -1 && currentIndex < afterIndex)
+            {
+                status.orderIssues.append(QString("应在 %1 之后加载").arg(mod->loadAfter[i]));
+            }
+        }
+        for (int i = 0; i < mod->forceLoadAfterIds.size(); ++i)
+        {
+            const int afterIndex = positionOf(mod->forceLoadAfterIds[i]);
+            if (afterIndex != -1 && currentIndex < afterIndex)
+            {
+                status.orderIssues.append(QString("必须在 %1 之后加载").arg(mod->forceLoadAfter[i]));
+            }
+        }
+        for (int i = 0; i < mod->loadBeforeIds.size(); ++i)
+        {
+            const int beforeIndex = positionOf(mod->loadBeforeIds[i]);
+            if (beforeIndex != -1 && currentIndex > beforeIndex)
+            {
+                status.orderIssues.append(QString("应在 %1 之前加载").arg(mod->loadBefore[i]));
+            }
+        }
+        for (int i = 0; i < mod->forceLoadBeforeIds.size(); ++i)
+        {
+            const int beforeIndex = positionOf(mod->forceLoadBeforeIds[i]);
+            if (beforeIndex != -1 && currentIndex > beforeIndex)
+            {
+                status.orderIssues.append(QString("必须在 %1 之前加载").arg(mod->forceLoadBefore[i]));
+            }
+        }
+
+    }
+
+    // 冲突索引是对称的，只有对方声明了不兼容时同样会报告
+    if (currentIndex >= 0)
+    {
+        for (quint32 other : m_manager->getConflictIds(id))
+        {
+            if (contains(other))
+            {
+                const ModItem *otherMod = m_manager->findModById(other);
+                const QString otherId = otherMod ? otherMod->packageId : m_manager->getPackageIdById(other);
+                status.incompatibilities.append(QString("与 %1 不兼容").arg(otherId));
+            }
+        }
+    }
+
+    if (m_status[id] == status)
+    {
+        return false;
+    }
+    m_status[id] = status;
+    return true;
+}
+
+void ActiveOrderIndex::linkReferences(const ModItem *mod)
+{
+    for (const QList<quint32> *ids : {&mod->dependencyIds, &mod->loadBeforeIds, &mod->loadAfterIds,
+                                      &mod->forceLoadBeforeIds, &mod->forceLoadAfterIds})
+    {
+        for (quint32 target : *ids)
+        {
+            ensureIdCapacity(target);
+            m_referencedBy[target].append(mod->modId);
+        }
+    }
+}
+
+void ActiveOrderIndex::unlinkReferences(const ModItem *mod)
+{
+    for (const QList<quint32> *ids : {&mod->dependencyIds, &mod->loadBeforeIds, &mod->loadAfterIds,
+                                      &mod->forceLoadBeforeIds, &mod->forceLoadAfterIds})
+    {
+        for (quint32 target : *ids)
+        {
+            if (target < quint32(m_referencedBy.size()))
+            {
+                m_referencedBy[target].removeOne(mod->modId);
+            }
+        }
+    }
+}
+
+const QList<quint32> &ActiveOrderIndex::referrersOf(quint32 id) const
+{
+    static const QList<quint32> empty;
+    return id < quint32(m_referencedBy.size()) ? m_referencedBy[id] : empty;
+}
+
+void ActiveOrderIndex::recomputeReferrers(quint32 id, int first, int last, QList<quint32> &changed)
+{
+    if (id >= quint32(m_referencedBy.size()))
+    {
+        return;
+    }
+
+    for (quint32 referrer : m_referencedBy[id])
+    {
+        const int position = positionOf(referrer);
+        if (position >= first && position <= last && recomputeStatus(referrer) && !changed.contains(referrer))
+        {
+            changed.append(referrer);
+        }
+    }
+}
+
+void ActiveOrderIndex::recomputeConflicts(quint32 id, QList<quint32> &changed)
+{
+    for (quint32 other : m_manager->getConflictIds(id))
+    {
+        if (contains(other) && recomputeStatus(other) && !changed.contains(other))
+        {
+            changed.append(other);
+        }
+    }
+}
+
+void ActiveOrderIndex::ensureIdCapacity(quint32 id)
+{
+    if (id == INVALID_MOD_ID || id < quint32(m_positions.size()))
+    {
+        return;
+    }
+
+    const qsizetype size = qsizetype(id) + 1;
+    m_positions.resize(size, -1);
+    m_status.resize(size);
+    m_referencedBy.resize(size);
+}
@@ -0,0 +1,100 @@
+#ifndef ACTIVEORDERINDEX_H
+#define ACTIVEORDERINDEX_H
+
+#include "ModItem.h"
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+class ModManager;
+
+/**
+ * @brief 激活列表的增量索引（加载顺序 + 依赖/顺序/不兼容校验结果）
+ *
+ * 按 ModManager 分配的整数ID记录每个Mod在激活列表中的位置，并缓存每个已安装Mod的校验结果。
+ * 单次编辑只处理受影响的区间（与 Pearce-Kelly 动态拓扑序相同的思路）：
+ * - 移动：位置只在起止位置之间变化，只有该区间内引用了被移动Mod的Mod需要重新校验
+ * - 插入/删除：后续位置整体平移，只有引用了该Mod的Mod和与它冲突的Mod需要重新校验
+ * 不兼容关系使用 ModManager 的对称冲突索引，只要一方声明即双方都会报告。
+ * 编辑的代价与区间长度和相关约束数成正比，而不是与整个列表成正比。
+ *
+ * ModManager 重新扫描或切换游戏版本后ID会变化，需要重新调用 reset()。
+ */
+class ActiveOrderIndex
+{
+public:
+    // 单个Mod的校验结果
+    struct ModStatus
+    {
+        QStringList missingDependencies; // 未满足的依赖（含强制前置）
+        QStringList orderIssues;         // 加载顺序错误
+        QStringList incompatibilities;   // 同时激活的不兼容Mod
+
+        bool isOk() const { return missingDependencies.isEmpty() && orderIssues.isEmpty() && incompatibilities.isEmpty(); }
+        bool operator==(const ModStatus &other) const
+        {
+            return missingDependencies == other.missingDependencies && orderIssues == other.orderIssues &&
+                   incompatibilities == other.incompatibilities;
+        }
+    };
+
+    ActiveOrderIndex() = default;
+
+    // 按激活列表完整重建，一次遍历完成全部校验（O(n+e)）
+    void reset(const QStringList &activeMods, ModManager *manager);
+
+    // 激活列表长度
+    int size() const { return int(m_order.size()); }
+
+    // 指定位置的Mod ID和Mod（未安装时为nullptr）
+    quint32 idAt(int position) const { return m_order.at(position); }
+    ModItem *modAt(int position) const;
+
+    // Mod在激活列表中的位置，未激活时返回-1
+    int positionOf(quint32 id) const;
+    int positionOf(const QString &packageId) const;
+    bool contains(quint32 id) const { return positionOf(id) >= 0; }
+
+    // 通过依赖或顺序约束引用了id的激活Mod（无序）
+    const QList<quint32> &referrersOf(quint32 id) const;
+
+    // 已安装的激活Mod的校验结果（其他ID返回空结果）
+    const ModStatus &statusOf(quint32 id) const;
+
+    // 存在问题的Mod数量
+    int issueCount() const;
+
+    // 激活列表中所有互不兼容的Mod对（每对只出现一次，按加载顺序）
+    QList<QPair<quint32, quint32>> conflictPairs() const;
+
+    // 编辑操作，返回校验结果发生变化的Mod ID（不含被删除的Mod）
+    QList<quint32> move(int from, int to);
+    QList<quint32> insert(int position, const QString &packageId);
+    QList<quint32> remove(int position);
+
+private:
+    // 重新计算一个Mod的校验结果，结果变化时返回true
+    bool recomputeStatus(quint32 id);
+
+    // 把Mod的约束目标加入/移出反向索引
+    void linkReferences(const ModItem *mod);
+    void unlinkReferences(const ModItem *mod);
+
+    // 重新计算引用了id的Mod（位置在 [first, last] 内的才会受影响）
+    void recomputeReferrers(quint32 id, int first, int last, QList<quint32> &changed);
+
+    // 重新计算与id冲突的激活Mod（不兼容与位置无关，只在插入/删除时变化）
+    void recomputeConflicts(quint32 id, QList<quint32> &changed);
+
+    // 保证按ID索引的数组足够长
+    void ensureIdCapacity(quint32 id);
+
+    ModManager *m_manager = nullptr;
+    QList<quint32> m_order;              // 位置到Mod ID
+    QList<int> m_positions;              // Mod ID到位置（未激活为-1）
+    QList<ModStatus> m_status;           // Mod ID到校验结果
+    QList<QList<quint32>> m_referencedBy; // Mod ID到引用它的激活Mod（依赖和顺序约束）
+};
+
+#endif // ACTIVEORDERINDEX_H
@@ -0,0 +1,201 @@
+#include "DependencyResolver.h"
+#include "ActiveOrderIndex.h"
+#include "ModManager.h"
+#include <QPair>
+
+DependencyResolver::DependencyResolver(ModManager *modManager)
+    : m_modManager(modManager)
+{
+}
+
+void DependencyResolver::ensureFresh()
+{
+    if (m_valid && m_generation == m_modManager->getGeneration())
+    {
+        return;
+    }
+
+    // 扫描后新增的ID不会对应已安装的Mod，按当前ID数量分配即可
+    const int idCount = m_modManager->getModIdCount();
+    m_closures.clear();
+    m_closures.resize(idCount);
+    m_computed.fill(false, idCount);
+    m_generation = m_modManager->getGeneration();
+    m_valid = true;
+}
+
+const QBitArray &DependencyResolver::closureOf(quint32 id)
+{
+    static const QBitArray empty;
+    ensureFresh();
+    const int n = int(m_closures.size());
+    if (id >= quint32(n))
+    {
+        return empty;
+    }
+    if (m_computed[id])
+    {
+        return m_closures[id];
+    }
+
+    QBitArray closure(n);
+    QBitArray seen(n);
+    seen.setBit(id);
+    QList<quint32> stack{id};
+    while (!stack.isEmpty())
+    {
+        const ModItem *mod = m_modManager->findModById(stack.takeLast());
+        if (!mod)
+        {
+            continue; // 未安装的Mod没有已知的依赖
+        }
+
+        for (const QList<quint32> *ids : {&mod->dependencyIds, &mod->forceLoadAfterIds})
+        {
+            for (quint32 target : *ids)
+            {
+                if (target >= quint32(n) || seen.testBit(target))
+                {
+                    continue;
+                }
+                seen.setBit(target);
+                closure.setBit(target);
+
+                // 已缓存的闭包是完整的，直接合并，不再展开
+                if (m_computed[target])
+                {
+                    closure |= m_closures[target];
+                    seen |= m_closures[target];
+                }
+                else
+                {
+                    stack.append(target);
+                }
+            }
+        }
+    }
+
+    // 循环依赖会把自身带入闭包
+    closure.clearBit(id);
+    m_closures[id] = closure;
+    m_computed[id] = true;
+    return m_closures[id];
+}
+
+DependencyPlan DependencyResolver::plan(const QList<quint32> &requested, const ActiveOrderIndex &active)
+{
+    DependencyPlan result;
+    ensureFresh();
+    const int n = int(m_closures.size());
+
+    QBitArray needed(n);
+    QBitArray requestedSet(n);
+    for (quint32 id : requested)
+    {
+        if (id < quint32(n))
+        {
+            requestedSet.setBit(id);
+            needed |= closureOf(id);
+        }
+    }
+
+    // 未安装的依赖只能提示；已经在激活列表中的（即使未安装）不算缺失
+    for (int id = 0; id < n; ++id)
+    {
+        if (needed.testBit(id) && !m_modManager->findModById(quint32(id)) && !active.contains(quint32(id)))
+        {
+            result.missing.append(m_modManager->getPackageIdById(quint32(id)));
+        }
+    }
+
+    auto isCandidate = [&](quint32 id)
+    {
+        return id < quint32(n) && (needed.testBit(id) || requestedSet.testBit(id)) &&
+               m_modManager->findModById(id) && !active.contains(id);
+    };
+
+    // 从请求的Mod出发做深度优先遍历，后序即为依赖在前的顺序
+    QBitArray visited(n);
+    QList<QPair<quint32, int>> stack; // (Mod ID, 下一条待访问的依赖)
+    for (quint32 root : requested)
+    {
+        if (!isCandidate(root) || visited.testBit(root))
+        {
+            continue;
+        }
+
+        visited.setBit(root);
+        stack.append({root, 0});
+        while (!stack.isEmpty())
+        {
+            auto &[node, next] = stack.last();
+            const ModItem *mod = m_modManager->findModById(node);
+            const int dependencyCount = int(mod->dependencyIds.size());
+            if (next < dependencyCount + mod->forceLoadAfterIds.size())
+            {
+                const quint32 target = next < dependencyCount ? mod->dependencyIds[next]
+                                                              : mod->forceLoadAfterIds[next - dependencyCount];
+                ++next;
+                if (isCandidate(target) && !visited.testBit(target))
+                {
+                    visited.setBit(target);
+                    stack.append({target, 0}); // node/next 引用在此之后失效
+                }
+                continue;
+            }
+
+            result.order.append(node);
+            if (!requestedSet.testBit(node))
+            {
+                result.dependencies.append(node);
+            }
+            stack.removeLast();
+        }
+    }
+
+    return result;
+}
+
+int DependencyResolver::officialBlockEnd(const ActiveOrderIndex &active)
+{
+    // 官方内容（Core和DLC）始终在最前面
+    int position = 0;
+    for (int p = 0; p < active.size(); ++p)
+    {
+        const ModItem *mod = active.modAt(p);
+        if (mod && mod->source == ModSource::Official)
+        {
+            position = p + 1;
+        }
+    }
+    return position;
+}
+
+int DependencyResolver::insertPosition(quint32 id, const ActiveOrderIndex &active, int minPosition) const
+{
+    int position = minPosition;
+
+    // 它自己声明的前置Mod必须在前面
+    const ModItem *mod = m_modManager->findModById(id);
+    if (mod)
+    {
+        for (const QList<quint32> *ids : {&mod->dependencyIds, &mod->forceLoadAfterIds, &mod->loadAfterIds})
+        {
+            for (quint32 target : *ids)
+            {
+                position = qMax(position, active.positionOf(target) + 1);
+            }
+        }
+    }
+
+    // 声明要在它之前加载的激活Mod也必须在前面（通过反向引用查找，不遍历整个列表）
+    for (quint32 referrer : active.referrersOf(id))
+    {
+        const ModItem *other = m_modManager->findModById(referrer);
+        if (other && (other->loadBeforeIds.contains(id) || other->forceLoadBeforeIds.contains(id)))
+        {
+            position = qMax(position, active.positionOf(referrer) + 1);
+        }
+    }
+    return position;
+}
@@ -0,0 +1,58 @@
+#ifndef DEPENDENCYRESOLVER_H
+#define DEPENDENCYRESOLVER_H
+
+#include <QBitArray>
+#include <QList>
+#include <QStringList>
+
+class ActiveOrderIndex;
+class ModManager;
+
+/**
+ * @brief 添加Mod时需要一并加入的依赖
+ */
+struct DependencyPlan
+{
+    QList<quint32> order;        // 需要加入激活列表的已安装Mod（依赖在前，含请求的Mod）
+    QList<quint32> dependencies; // order中由依赖关系引入的Mod
+    QStringList missing;         // 依赖闭包中未安装的PackageId（小写）
+
+    bool hasDependencies() const { return !dependencies.isEmpty(); }
+};
+
+/**
+ * @brief 依赖传递闭包求解器（modDependencies + forceLoadAfter）
+ *
+ * 每个Mod的闭包以整数ID为下标的位图缓存，搜索时遇到已缓存闭包的Mod直接合并，不再展开。
+ * ModManager 的修改代数变化（扫描、重扫、切换游戏版本）后缓存整体失效。
+ */
+class DependencyResolver
+{
+public:
+    explicit DependencyResolver(ModManager *modManager);
+
+    // Mod的依赖闭包（不含自身，含未安装的ID）
+    const QBitArray &closureOf(quint32 id);
+
+    // 计算添加requested时需要一并加入的Mod（已在激活列表中的Mod不会出现在结果中）
+    DependencyPlan plan(const QList<quint32> &requested, const ActiveOrderIndex &active);
+
+    // 官方内容（Core和DLC）之后的第一个位置，依赖Mod不会插入到它之前
+    static int officialBlockEnd(const ActiveOrderIndex &active);
+
+    // 依赖Mod在激活列表中的插入位置：不早于minPosition（一般为 officialBlockEnd()），
+    // 且在它已激活的前置Mod、以及声明了 loadBefore/forceLoadBefore 它的激活Mod之后
+    int insertPosition(quint32 id, const ActiveOrderIndex &active, int minPosition) const;
+
+private:
+    // 缓存过期时按当前ID数量重置
+    void ensureFresh();
+
+    ModManager *m_modManager;
+    QList<QBitArray> m_closures; // ID到依赖闭包
+    QList<bool> m_computed;      // 闭包是否已计算
+    quint64 m_generation = 0;
+    bool m_valid = false;
+};
+
+#endif // DEPENDENCYRESOLVER_H
@@ -0,0 +1,60 @@
+#include "MappedFile.h"
+#include <atomic>
+
+namespace
+{
+    std::atomic<bool> s_memoryMapEnabled{true};
+}
+
+MappedFile::MappedFile(const QString &filePath)
+    : m_file(filePath)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    // 先释放视图再解除映射
+    m_data = QByteArray();
+    if (m_mapped)
+    {
+        m_file.unmap(m_mapped);
+    }
+}
+
+bool MappedFile::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    if (size <= 0)
+    {
+        return true; // 空文件无法映射，内容为空
+    }
+
+    if (isMemoryMapEnabled())
+    {
+        m_mapped = m_file.map(0, size);
+        if (m_mapped)
+        {
+            m_data = QByteArray::fromRawData(reinterpret_cast<const char *>(m_mapped), size);
+            return true;
+        }
+    }
+
+    // 回退：一次性读入缓冲区
+    m_data = m_file.readAll();
+    return true;
+}
+
+void MappedFile::setMemoryMapEnabled(bool enabled)
+{
+    s_memoryMapEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool MappedFile::isMemoryMapEnabled()
+{
+    return s_memoryMapEnabled.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,46 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+/**
+ * @brief 只读文件内容
+ *
+ * 启用内存映射时通过 QFile::map 映射整个文件，data() 返回 QByteArray::fromRawData 视图，
+ * 解析器直接在映射区上分词，不产生中间缓冲区和UTF-16转换；
+ * 映射失败或关闭内存映射时回退为 readAll()。
+ *
+ * 注意：data() 返回的视图只在 MappedFile 对象存活期间有效。
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const QString &filePath);
+
+    ~MappedFile();
+
+    // 打开并映射（或读取）文件
+    bool open();
+
+    // 文件内容
+    const QByteArray &data() const { return m_data; }
+
+    // 是否通过内存映射读取
+    bool isMapped() const { return m_mapped != nullptr; }
+
+    // 全局开关：是否使用内存映射读取（默认开启）
+    static void setMemoryMapEnabled(bool enabled);
+
+    static bool isMemoryMapEnabled();
+
+private:
+    QFile m_file;
+    uchar *m_mapped = nullptr;
+    QByteArray m_data;
+
+    Q_DISABLE_COPY(MappedFile)
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,351 @@
+#include "ModCatalogCache.h"
+#include "MappedFile.h"
+#include "UserDataManager.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <cstring>
+
+namespace
+{
+    // 文件头
+    struct CacheHeader
+    {
+        quint32 magic;
+        quint32 formatVersion;
+        quint32 entryCount;
+        quint32 reserved;
+    };
+    static_assert(sizeof(CacheHeader) == 16, "CacheHeader must stay 16 bytes");
+
+    constexpr quint32 CACHE_MAGIC = 0x434D5245; // "ERMC"
+    constexpr quint32 CACHE_FORMAT_VERSION = 4; // 解析规则变化时递增，使旧缓存失效
+
+    const QString CACHE_FILE = "catalog.cache";
+}
+
+ModCatalogCache::ModCatalogCache()
+    : m_cacheFilePath(getDefaultCachePath())
+{
+}
+
+ModCatalogCache::ModCatalogCache(const QString &cacheFilePath)
+    : m_cacheFilePath(cacheFilePath)
+{
+}
+
+ModCatalogCache::~ModCatalogCache()
+{
+    unmap();
+}
+
+void ModCatalogCache::setCacheFilePath(const QString &path)
+{
+    clear();
+    m_cacheFilePath = path;
+}
+
+bool ModCatalogCache::load()
+{
+    if (m_loaded)
+    {
+        return true;
+    }
+
+    m_loaded = true;
+    m_hitCount.storeRelaxed(0);
+    m_missCount.storeRelaxed(0);
+
+    m_file.setFileName(m_cacheFilePath);
+    if (!m_file.exists())
+    {
+        qDebug() << "[ModCatalogCache] 缓存文件不存在，将进行完整扫描";
+        return true; // 文件不存在不算错误
+    }
+
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "[ModCatalogCache] 无法打开缓存文件:" << m_cacheFilePath;
+        return false;
+    }
+
+    const qint64 fileSize = m_file.size();
+    if (fileSize < qint64(sizeof(CacheHeader)))
+    {
+        unmap();
+        return false;
+    }
+
+    m_mapped = m_file.map(0, fileSize);
+    if (!m_mapped)
+    {
+        qWarning() << "[ModCatalogCache] 无法映射缓存文件:" << m_cacheFilePath;
+        unmap();
+        return false;
+    }
+    m_mappedSize = fileSize;
+
+    CacheHeader header;
+    std::memcpy(&header, m_mapped, sizeof(header));
+    const qint64 tableEnd = qint64(sizeof(CacheHeader)) + qint64(header.entryCount) * qint64(sizeof(EntryRecord));
+    if (header.magic != CACHE_MAGIC || header.formatVersion != CACHE_FORMAT_VERSION || tableEnd > m_mappedSize)
+    {
+        qDebug() << "[ModCatalogCache] 缓存文件版本不匹配或已损坏，忽略";
+        unmap();
+        return true;
+    }
+
+    // 只读取条目表和来源路径，序列化数据在命中时才访问
+    m_index.reserve(header.entryCount);
+    const uchar *table = m_mapped + sizeof(CacheHeader);
+    for (quint32 i = 0; i < header.entryCount; ++i)
+    {
+        EntryRecord record;
+        std::memcpy(&record, table + i * sizeof(EntryRecord), sizeof(record));
+
+        const qint64 keyEnd = qint64(record.keyOffset) + qint64(record.keyLength) * qint64(sizeof(QChar));
+        const qint64 dataEnd = qint64(record.dataOffset) + qint64(record.dataLength);
+        if (keyEnd > m_mappedSize || dataEnd > m_mappedSize || (record.keyOffset % sizeof(QChar)) != 0)
+        {
+            continue; // 跳过越界条目
+        }
+
+        QString key(reinterpret_cast<const QChar *>(m_mapped + record.keyOffset), record.keyLength);
+        m_index.insert(key, record);
+    }
+
+    qDebug() << "[ModCatalogCache] 已加载" << m_index.size() << "个缓存条目";
+    return true;
+}
+
+bool ModCatalogCache::save()
+{
+    // 先在内存中组装完整文件（命中的条目仍引用映射区），再关闭映射写入磁盘
+    QList<QString> keys;
+    QList<LiveEntry> entries;
+    {
+        QMutexLocker locker(&m_liveMutex);
+        keys = m_liveEntries.keys();
+        entries.reserve(keys.size());
+        for (const QString &key : keys)
+        {
+            entries.append(m_liveEntries.value(key));
+        }
+    }
+
+    QList<EntryRecord> records(keys.size());
+    QByteArray blob;
+    const qint64 blobStart = qint64(sizeof(CacheHeader)) + qint64(keys.size()) * qint64(sizeof(EntryRecord));
+
+    for (int i = 0; i < keys.size(); ++i)
+    {
+        const QString &key = keys[i];
+        const LiveEntry &entry = entries[i];
+        EntryRecord &record = records[i];
+
+        record.aboutSize = entry.aboutSize;
+        record.aboutMtime = entry.aboutMtime;
+        record.aboutHash = entry.aboutHash;
+
+        record.keyOffset = quint32(blobStart + blob.size());
+        record.keyLength = quint32(key.size());
+        blob.append(reinterpret_cast<const char *>(key.constData()), key.size() * qsizetype(sizeof(QChar)));
+
+        record.dataOffset = quint32(blobStart + blob.size());
+        record.dataLength = quint32(entry.payload.size());
+        blob.append(entry.payload);
+
+        // 保证下一个来源路径按UTF-16对齐
+        if (blob.size() % 2 != 0)
+        {
+            blob.append('\0');
+        }
+    }
+
+    CacheHeader header;
+    header.magic = CACHE_MAGIC;
+    header.formatVersion = CACHE_FORMAT_VERSION;
+    header.entryCount = quint32(keys.size());
+    header.reserved = 0;
+
+    QByteArray output;
+    output.reserve(blobStart + blob.size());
+    output.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.append(reinterpret_cast<const char *>(records.constData()), records.size() * qsizetype(sizeof(EntryRecord)));
+    output.append(blob);
+
+    entries.clear();
+    clear();
+
+    // 写入临时文件后原子替换，写到一半失败或崩溃不会留下截断的缓存
+    QDir().mkpath(QFileInfo(m_cacheFilePath).absolutePath());
+    QSaveFile file(m_cacheFilePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "[ModCatalogCache] 无法写入缓存文件:" << m_cacheFilePath << file.errorString();
+        return false;
+    }
+
+    if (file.write(output) != output.size())
+    {
+        file.cancelWriting();
+        qWarning() << "[ModCatalogCache] 写入缓存文件失败:" << m_cacheFilePath << file.errorString();
+        return false;
+    }
+
+    if (!file.commit())
+    {
+        qWarning() << "[ModCatalogCache] 无法提交缓存文件:" << m_cacheFilePath << file.errorString();
+        return false;
+    }
+
+    qDebug() << "[ModCatalogCache] 已保存" << keys.size() << "个缓存条目";
+    return true;
+}
+
+void ModCatalogCache::clear()
+{
+    {
+        QMutexLocker locker(&m_liveMutex);
+        m_liveEntries.clear();
+    }
+    m_index.clear();
+    unmap();
+    m_loaded = false;
+}
+
+void ModCatalogCache::remove(const QString &sourcePath)
+{
+    QMutexLocker locker(&m_liveMutex);
+    m_liveEntries.remove(sourcePath);
+}
+
+ModItem *ModCatalogCache::loadOrParse(const QString &sourcePath, const QString &aboutXmlPath, const Parser &parser)
+{
+    QFileInfo aboutInfo(aboutXmlPath);
+    if (!aboutInfo.exists())
+    {
+        return nullptr;
+    }
+
+    const quint64 aboutSize = quint64(aboutInfo.size());
+    const qint64 aboutMtime = aboutInfo.lastModified().toMSecsSinceEpoch();
+
+    auto it = m_index.constFind(sourcePath);
+    const EntryRecord *record = (it != m_index.constEnd()) ? &it.value() : nullptr;
+
+    // 快速路径：大小和修改时间都未变化，不读取About.xml
+    if (record && record->aboutSize == aboutSize && record->aboutMtime == aboutMtime)
+    {
+        QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_mapped + record->dataOffset),
+                                                     record->dataLength);
+        ModItem *mod = deserialize(payload);
+        if (mod)
+        {
+            keepEntry(sourcePath, {aboutSize, aboutMtime, record->aboutHash, payload});
+            m_hitCount.ref();
+            return mod;
+        }
+    }
+
+    // 哈希和解析都直接作用于映射区，不复制文件内容
+    MappedFile file(aboutXmlPath);
+    if (!file.open())
+    {
+        return nullptr;
+    }
+
+    const QByteArray &data = file.data();
+    const quint64 aboutHash = contentHash(data);
+
+    // 修改时间变化但内容未变（如Steam重新下载），复用缓存条目
+    if (record && record->aboutSize == aboutSize && record->aboutHash == aboutHash)
+    {
+        QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_mapped + record->dataOffset),
+                                                     record->dataLength);
+        ModItem *mod = deserialize(payload);
+        if (mod)
+        {
+            keepEntry(sourcePath, {aboutSize, aboutMtime, aboutHash, payload});
+            m_hitCount.ref();
+            return mod;
+        }
+    }
+
+    ModItem *mod = new ModItem();
+    if (!parser(mod, data))
+    {
+        delete mod;
+        return nullptr;
+    }
+
+    keepEntry(sourcePath, {aboutSize, aboutMtime, aboutHash, serialize(*mod)});
+    m_missCount.ref();
+    return mod;
+}
+
+QString ModCatalogCache::getDefaultCachePath()
+{
+    return QDir(UserDataManager::getUserDataPath()).absoluteFilePath(CACHE_FILE);
+}
+
+quint64 ModCatalogCache::contentHash(const QByteArray &data)
+{
+    quint64 hash = 14695981039346656037ULL;
+    for (char c : data)
+    {
+        hash ^= quint64(uchar(c));
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+ModItem *ModCatalogCache::deserialize(const QByteArray &payload)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    ModItem *mod = new ModItem();
+    in >> *mod;
+
+    if (in.status() != QDataStream::Ok || !mod->isValid())
+    {
+        delete mod;
+        return nullptr;
+    }
+
+    return mod;
+}
+
+QByteArray ModCatalogCache::serialize(const ModItem &mod)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << mod;
+    return payload;
+}
+
+void ModCatalogCache::keepEntry(const QString &sourcePath, const LiveEntry &entry)
+{
+    QMutexLocker locker(&m_liveMutex);
+    m_liveEntries.insert(sourcePath, entry);
+}
+
+void ModCatalogCache::unmap()
+{
+    if (m_mapped)
+    {
+        m_file.unmap(const_cast<uchar *>(m_mapped));
+        m_mapped = nullptr;
+    }
+    m_mappedSize = 0;
+    if (m_file.isOpen())
+    {
+        m_file.close();
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef MODCATALOGCACHE_H
+#define MODCATALOGCACHE_H
+
+#include "ModItem.h"
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief Mod解析缓存（磁盘二进制目录）
+ *
+ * 将每个Mod目录的About.xml解析结果持久化到 UserData/catalog.cache，
+ * 以Mod来源目录为键，并记录About.xml的大小、修改时间和内容哈希：
+ * - 大小和修改时间都未变化：直接反序列化缓存条目，不读取About.xml
+ * - 修改时间变化但大小和内容哈希相同（如Steam重新下载）：复用缓存条目
+ * - 其他情况：重新解析并更新缓存
+ *
+ * 文件格式（本机字节序，可直接内存映射）：
+ * [文件头 16字节] [条目表 N × 40字节] [数据区：来源路径(UTF-16) + ModItem序列化数据]
+ *
+ * 使用方式：扫描开始前调用 load()，扫描结束后调用 save()。
+ * save() 只写回本次扫描访问过的条目，已删除的Mod会被自动清理；
+ * 增量重扫发现Mod被删除时通过 remove() 立即丢弃其条目。
+ * loadOrParse() 可在多个扫描线程中并发调用。
+ */
+class ModCatalogCache
+{
+public:
+    // 解析函数：从About.xml的原始内容填充ModItem
+    using Parser = std::function<bool(ModItem *mod, const QByteArray &data)>;
+
+    ModCatalogCache();
+
+    explicit ModCatalogCache(const QString &cacheFilePath);
+
+    ~ModCatalogCache();
+
+    // 设置缓存文件路径
+    void setCacheFilePath(const QString &path);
+
+    QString getCacheFilePath() const { return m_cacheFilePath; }
+
+    // 映射缓存文件并建立索引（已加载时直接返回）
+    bool load();
+
+    // 写回本次访问过的条目并关闭映射
+    bool save();
+
+    // 关闭映射并丢弃所有条目
+    void clear();
+
+    // 丢弃Mod目录的条目（增量重扫发现Mod已删除时调用），之后的 save() 不再写回
+    void remove(const QString &sourcePath);
+
+    // 读取Mod目录的About.xml：命中缓存时反序列化，否则调用parser解析并写入缓存
+    // 返回新建的ModItem（调用者负责释放），失败返回nullptr
+    ModItem *loadOrParse(const QString &sourcePath, const QString &aboutXmlPath, const Parser &parser);
+
+    // 本次扫描的命中/未命中次数
+    int getHitCount() const { return m_hitCount.loadRelaxed(); }
+
+    int getMissCount() const { return m_missCount.loadRelaxed(); }
+
+    // 获取默认缓存文件路径（UserData/catalog.cache）
+    static QString getDefaultCachePath();
+
+    // About.xml内容哈希（FNV-1a 64位，跨进程稳定）
+    static quint64 contentHash(const QByteArray &data);
+
+private:
+    // 磁盘上的条目记录（固定40字节）
+    struct EntryRecord
+    {
+        quint64 aboutSize;  // About.xml 大小
+        qint64 aboutMtime;  // About.xml 修改时间（毫秒时间戳）
+        quint64 aboutHash;  // About.xml 内容哈希
+        quint32 keyOffset;  // 来源路径在文件中的偏移
+        quint32 keyLength;  // 来源路径长度（UTF-16字符数）
+        quint32 dataOffset; // 序列化数据在文件中的偏移
+        quint32 dataLength; // 序列化数据长度
+    };
+    static_assert(sizeof(EntryRecord) == 40, "EntryRecord must stay 40 bytes");
+
+    // 待写回的条目
+    struct LiveEntry
+    {
+        quint64 aboutSize = 0;
+        qint64 aboutMtime = 0;
+        quint64 aboutHash = 0;
+        QByteArray payload; // 命中时为映射区视图，新解析时为自有数据
+    };
+
+    QString m_cacheFilePath;
+    QFile m_file;                   // 已映射的缓存文件
+    const uchar *m_mapped = nullptr; // 映射起始地址
+    qint64 m_mappedSize = 0;         // 映射长度
+    bool m_loaded = false;
+
+    QHash<QString, EntryRecord> m_index; // 来源路径 -> 映射区中的条目（load后只读）
+
+    QMutex m_liveMutex;
+    QHash<QString, LiveEntry> m_liveEntries; // 本次扫描访问过的条目
+
+    QAtomicInt m_hitCount;
+    QAtomicInt m_missCount;
+
+    // 从序列化数据创建ModItem
+    static ModItem *deserialize(const QByteArray &payload);
+
+    // 序列化ModItem
+    static QByteArray serialize(const ModItem &mod);
+
+    // 记录需要写回的条目
+    void keepEntry(const QString &sourcePath, const LiveEntry &entry);
+
+    // 关闭映射
+    void unmap();
+};
+
+#endif // MODCATALOGCACHE_H
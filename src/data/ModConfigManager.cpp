@@ -1,11 +1,157 @@
 #include "ModConfigManager.h"
+#include "MappedFile.h"
 #include "ModItem.h"
+#include "PersistenceService.h"
+#include <QByteArrayView>
+#include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QStandardPaths>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+namespace
+{
+    // QXmlStreamReader 的位置按UTF-16字符计算，这里按UTF-8编码换算为字节位置。
+    // 查询的位置单调递增，游标只向前移动，整个文档的换算总代价为 O(n)
+    class Utf8OffsetMapper
+    {
+    public:
+        explicit Utf8OffsetMapper(const QByteArray &data)
+            : m_data(data)
+        {
+            // 解码器会跳过BOM，BOM不计入字符位置
+            if (m_data.startsWith("\xEF\xBB\xBF"))
+            {
+                m_start = m_byte = 3;
+            }
+        }
+
+        qsizetype byteOffset(qint64 charOffset)
+        {
+            if (charOffset < m_char)
+            {
+                m_byte = m_start;
+                m_char = 0;
+            }
+
+            while (m_char < charOffset && m_byte < m_data.size())
+            {
+                const uchar lead = uchar(m_data[m_byte]);
+                const int length = lead < 0xC0 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+                m_byte += length;
+                m_char += length == 4 ? 2 : 1; // 4字节编码对应一对代理项
+            }
+            return qMin(m_byte, m_data.size());
+        }
+
+    private:
+        const QByteArray &m_data;
+        qsizetype m_start = 0;
+        qsizetype m_byte = 0;
+        qint64 m_char = 0;
+    };
+
+    bool isXmlSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    // 在approx附近查找 "<name" 开始标签。分词器可能已经读过了 '<'，所以先跳过空白向后找，再向前回找
+    qsizetype findStartTag(const QByteArray &data, qsizetype approx, const QByteArray &name)
+    {
+        auto matches = [&](qsizetype p)
+        {
+            const qsizetype after = p + 1 + name.size();
+            return p >= 0 && after < data.size() && data[p] == '<' &&
+                   QByteArrayView(data).sliced(p + 1, name.size()) == name &&
+                   (isXmlSpace(data[after]) || data[after] == '>' || data[after] == '/');
+        };
+
+        qsizetype p = approx;
+        while (p < data.size() && isXmlSpace(data[p]))
+        {
+            ++p;
+        }
+        if (matches(p))
+        {
+            return p;
+        }
+
+        for (qsizetype q = qMin(approx, data.size() - 1); q >= 0 && approx - q <= 16; --q)
+        {
+            if (data[q] == '<')
+            {
+                return matches(q) ? q : -1;
+            }
+        }
+        return -1;
+    }
+
+    // 结束标签的 '>' 之后的位置（分词器可能多读了几个字符，向前回找）
+    qsizetype findTagEnd(const QByteArray &data, qsizetype approx)
+    {
+        const qsizetype p = qMin(approx, data.size());
+        for (qsizetype q = p; q > 0 && p - q <= 16; --q)
+        {
+            if (data[q - 1] == '>')
+            {
+                return q;
+            }
+        }
+        return -1;
+    }
+
+    // 无法定位原始字节时（非UTF-8编码等），按读到的记号重新序列化整个子树
+    QByteArray serializeElement(QXmlStreamReader &xml)
+    {
+        QByteArray raw;
+        QXmlStreamWriter writer(&raw);
+        int depth = 0;
+        while (!xml.hasError())
+        {
+            writer.writeCurrentToken(xml);
+            if (xml.isStartElement())
+            {
+                ++depth;
+            }
+            else if (xml.isEndElement() && --depth == 0)
+            {
+                break;
+            }
+            xml.readNext();
+        }
+        return raw;
+    }
+
+    // 读取当前元素的整个子树，返回其原始字节（换行统一为 \n，写入时按文本模式转换）
+    QByteArray captureElement(QXmlStreamReader &xml, const QByteArray &data, Utf8OffsetMapper &offsets,
+                              qint64 tokenStart)
+    {
+        const QStringView encoding = xml.documentEncoding();
+        const bool utf8 = encoding.isEmpty() || encoding.compare(u"utf-8", Qt::CaseInsensitive) == 0;
+        const qsizetype start =
+            utf8 ? findStartTag(data, offsets.byteOffset(tokenStart), xml.qualifiedName().toUtf8()) : -1;
+        if (start < 0)
+        {
+            qDebug() << "[ModConfigManager] Re-serializing unknown element" << xml.name();
+            return serializeElement(xml);
+        }
+
+        xml.skipCurrentElement();
+        const qsizetype end = findTagEnd(data, offsets.byteOffset(xml.characterOffset()));
+        if (end <= start)
+        {
+            qWarning() << "[ModConfigManager] Failed to locate the end of unknown element at byte" << start;
+            return QByteArray();
+        }
+
+        QByteArray raw = data.mid(start, end - start);
+        raw.replace("\r\n", "\n");
+        return raw;
+    }
+}
+
 ModConfigManager::ModConfigManager()
     : m_configPath(getDefaultConfigPath())
 {
@@ -25,16 +171,14 @@ bool ModConfigManager::loadConfig(const QString &configPath)
 {
     m_configPath = configPath;
 
-    QFile file(configPath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // 直接把原始字节交给解析器，不先转换为UTF-16
+    MappedFile file(configPath);
+    if (!file.open())
     {
         return false;
     }
 
-    QString xmlContent = file.readAll();
-    file.close();
-
-    return parseXml(xmlContent);
+    return parseXml(file.data());
 }
 
 bool ModConfigManager::loadConfigWithEmptyMods()
@@ -46,17 +190,15 @@ bool ModConfigManager::loadConfigWithEmptyMods(const QString &configPath)
 {
     m_configPath = configPath;
 
-    QFile file(configPath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    // 直接把原始字节交给解析器，不先转换为UTF-16
+    MappedFile file(configPath);
+    if (!file.open())
     {
         return false;
     }
 
-    QString xmlContent = file.readAll();
-    file.close();
-
     // 解析配置文件
-    if (!parseXml(xmlContent))
+    if (!parseXml(file.data()))
     {
         return false;
     }
@@ -66,6 +208,7 @@ bool ModConfigManager::loadConfigWithEmptyMods(const QString &configPath)
     // 只保留version和其他字段
     m_activeMods.clear();
     m_knownExpansions.clear();
+    ++m_generation;
 
     return true;
 }
@@ -77,38 +220,41 @@ bool ModConfigManager::saveConfig()
 
 bool ModConfigManager::saveConfig(const QString &configPath)
 {
-    m_configPath = configPath;
-
-    // 确保目录存在
-    QFileInfo fileInfo(configPath);
-    QDir dir = fileInfo.dir();
-    if (!dir.exists())
-    {
-        dir.mkpath(".");
-    }
+    return saveConfigAsync(configPath).result();
+}
 
-    QFile file(configPath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        return false;
-    }
+QFuture<bool> ModConfigManager::saveConfigAsync()
+{
+    return saveConfigAsync(m_configPath);
+}
 
-    QString xmlContent = generateXml();
-    file.write(xmlContent.toUtf8());
-    file.close();
+QFuture<bool> ModConfigManager::saveConfigAsync(const QString &configPath)
+{
+    m_configPath = configPath;
 
-    return true;
+    // 复制一份配置作为快照（字符串隐式共享），XML在工作线程中生成并原子写入
+    const ModConfigManager snapshot = *this;
+    return PersistenceService::instance().save(
+        configPath, [snapshot](QIODevice *device)
+        { return snapshot.writeXml(device); },
+        QIODevice::WriteOnly | QIODevice::Text);
 }
 
 void ModConfigManager::setActiveMods(const QStringList &mods)
 {
-    m_activeMods = mods;
+    const int dropped = m_activeMods.assign(mods);
+    if (dropped > 0)
+    {
+        qDebug() << "[ModConfigManager] Dropped" << dropped << "duplicate active mods";
+    }
+    ++m_generation;
 }
 
 void ModConfigManager::setActiveModsFromList(const QList<ModItem *> &modList)
 {
     m_activeMods.clear();
     m_knownExpansions.clear();
+    ++m_generation;
 
     for (ModItem *mod : modList)
     {
@@ -117,8 +263,11 @@ void ModConfigManager::setActiveModsFromList(const QList<ModItem *> &modList)
             continue;
         }
 
-        // 所有mod都加入activeMods
-        m_activeMods.append(mod->packageId);
+        // 所有mod都加入activeMods（重复的PackageId只加入一次）
+        if (!m_activeMods.append(mod->packageId))
+        {
+            continue;
+        }
 
         // 只有官方DLC（isOfficialDLC=true）才加入knownExpansions
         // Core不会被加入，因为在OfficialDLCScanner中已经将其isOfficialDLC设为false
@@ -131,38 +280,35 @@ void ModConfigManager::setActiveModsFromList(const QList<ModItem *> &modList)
 
 void ModConfigManager::addMod(const QString &modId)
 {
-    if (!modId.isEmpty() && !m_activeMods.contains(modId))
+    if (m_activeMods.append(modId))
     {
-        m_activeMods.append(modId);
+        ++m_generation;
     }
 }
 
 void ModConfigManager::removeMod(const QString &modId)
 {
-    m_activeMods.removeAll(modId);
+    if (m_activeMods.remove(modId))
+    {
+        ++m_generation;
+    }
 }
 
 void ModConfigManager::insertMod(int index, const QString &modId)
 {
-    if (!modId.isEmpty() && !m_activeMods.contains(modId))
+    // 超出范围时追加到末尾
+    if (m_activeMods.insert(index, modId))
     {
-        if (index < 0 || index > m_activeMods.size())
-        {
-            m_activeMods.append(modId);
-        }
-        else
-        {
-            m_activeMods.insert(index, modId);
-        }
+        ++m_generation;
     }
 }
 
 bool ModConfigManager::moveModUp(const QString &modId)
 {
     int index = m_activeMods.indexOf(modId);
-    if (index > 0)
+    if (index > 0 && m_activeMods.move(modId, index - 1))
     {
-        m_activeMods.move(index, index - 1);
+        ++m_generation;
         return true;
     }
     return false;
@@ -171,9 +317,9 @@ bool ModConfigManager::moveModUp(const QString &modId)
 bool ModConfigManager::moveModDown(const QString &modId)
 {
     int index = m_activeMods.indexOf(modId);
-    if (index >= 0 && index < m_activeMods.size() - 1)
+    if (index >= 0 && m_activeMods.move(modId, index + 1))
     {
-        m_activeMods.move(index, index + 1);
+        ++m_generation;
         return true;
     }
     return false;
@@ -181,10 +327,9 @@ bool ModConfigManager::moveModDown(const QString &modId)
 
 bool ModConfigManager::moveModToPosition(const QString &modId, int newPosition)
 {
-    int currentIndex = m_activeMods.indexOf(modId);
-    if (currentIndex >= 0 && newPosition >= 0 && newPosition < m_activeMods.size())
+    if (m_activeMods.move(modId, newPosition))
     {
-        m_activeMods.move(currentIndex, newPosition);
+        ++m_generation;
         return true;
     }
     return false;
@@ -213,17 +358,20 @@ QString ModConfigManager::getDefaultConfigPath()
     return QDir(localLowPath).absoluteFilePath("Ludeon Studios/RimWorld by Ludeon Studios/Config/ModsConfig.xml");
 }
 
-bool ModConfigManager::parseXml(const QString &xmlContent)
+bool ModConfigManager::parseXml(const QByteArray &xmlContent)
 {
     QXmlStreamReader xml(xmlContent);
+    Utf8OffsetMapper offsets(xmlContent);
 
     m_activeMods.clear();
+    ++m_generation;
     m_knownExpansions.clear();
     m_version.clear();
     m_otherFields.clear();
 
     while (!xml.atEnd() && !xml.hasError())
     {
+        const qint64 tokenStart = xml.characterOffset();
         QXmlStreamReader::TokenType token = xml.readNext();
 
         if (token == QXmlStreamReader::StartElement)
@@ -251,6 +399,7 @@ bool ModConfigManager::parseXml(const QString &xmlContent)
                         xml.name() == "li")
                     {
                         QString modId = xml.readElementText();
+                        // 重复项只保留第一次出现的
                         if (!modId.isEmpty())
                         {
                             m_activeMods.append(modId);
@@ -278,9 +427,12 @@ bool ModConfigManager::parseXml(const QString &xmlContent)
             }
             else
             {
-                // 保存其他未知字段
-                QString value = xml.readElementText();
-                m_otherFields[elementName] = value;
+                // 保存其他未知字段（整个子树的原始字节）
+                QByteArray raw = captureElement(xml, xmlContent, offsets, tokenStart);
+                if (!raw.isEmpty())
+                {
+                    m_otherFields.append({elementName, raw});
+                }
             }
         }
     }
@@ -288,10 +440,23 @@ bool ModConfigManager::parseXml(const QString &xmlContent)
     return !xml.hasError();
 }
 
-QString ModConfigManager::generateXml() const
+QMap<QString, QString> ModConfigManager::getOtherFields() const
+{
+    QMap<QString, QString> fields;
+    for (const RawElement &element : m_otherFields)
+    {
+        QXmlStreamReader xml(element.xml);
+        if (xml.readNextStartElement())
+        {
+            fields[element.name] = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+        }
+    }
+    return fields;
+}
+
+bool ModConfigManager::writeXml(QIODevice *device) const
 {
-    QString xml;
-    QXmlStreamWriter writer(&xml);
+    QXmlStreamWriter writer(device);
 
     writer.setAutoFormatting(true);
     writer.setAutoFormattingIndent(2);
@@ -307,7 +472,7 @@ QString ModConfigManager::generateXml() const
 
     // 写入激活的Mod列表（包括核心、DLC和创意工坊mod）
     writer.writeStartElement("activeMods");
-    for (const QString &modId : m_activeMods)
+    for (const QString &modId : m_activeMods.toStringList())
     {
         writer.writeTextElement("li", modId);
     }
@@ -321,14 +486,15 @@ QString ModConfigManager::generateXml() const
     }
     writer.writeEndElement(); // knownExpansions
 
-    // 写入其他保存的字段（保持原样）
-    for (auto it = m_otherFields.begin(); it != m_otherFields.end(); ++it)
+    // 其他字段直接写入原始字节（QXmlStreamWriter 不缓存输出，此时前面的内容已经写入device）
+    for (const RawElement &element : m_otherFields)
     {
-        writer.writeTextElement(it.key(), it.value());
+        device->write("\n  ");
+        device->write(element.xml);
     }
 
     writer.writeEndElement(); // ModsConfigData
     writer.writeEndDocument();
 
-    return xml;
+    return !writer.hasError();
 }
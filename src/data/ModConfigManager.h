@@ -1,6 +1,10 @@
 #ifndef MODCONFIGMANAGER_H
 #define MODCONFIGMANAGER_H
 
+#include "ActiveModList.h"
+#include <QByteArray>
+#include <QFuture>
+#include <QIODevice>
 #include <QList>
 #include <QMap>
 #include <QString>
@@ -14,7 +18,10 @@ struct ModItem; // 前向声明
  * 负责读取和写入 RimWorld 的 ModsConfig.xml 文件
  * 该文件位于 C:\Users\{username}\AppData\LocalLow\Ludeon Studios\RimWorld by Ludeon Studios\Config\ModsConfig.xml
  *
- * 注意：会保留原文件中除 activeMods 和 knownExpansions 外的所有字段
+ * 注意：会保留原文件中除 activeMods 和 knownExpansions 外的所有字段，
+ * 未识别的元素按原始字节保存，写回时原样拼接（包括嵌套内容和属性）
+ *
+ * 激活列表中的PackageId不区分大小写且不重复（与游戏一致），查询和移动不需要线性扫描。
  */
 class ModConfigManager
 {
@@ -33,14 +40,19 @@ public:
 
     bool loadConfigWithEmptyMods(const QString &configPath);
 
-    // 保存配置
+    // 保存配置（通过临时文件原子替换，等待写入完成）
     bool saveConfig();
 
     bool saveConfig(const QString &configPath);
 
-    // 获取当前激活的Mod列表（按加载顺序）
+    // 异步保存配置：立即复制快照，在工作线程中生成XML并原子写入（连续调用会合并）
+    QFuture<bool> saveConfigAsync();
+
+    QFuture<bool> saveConfigAsync(const QString &configPath);
+
+    // 获取当前激活的Mod列表（按加载顺序，只读视图，修改激活列表后失效）
     // 注意：activeMods包含所有激活的mod（核心、DLC、创意工坊mod）
-    QStringList getActiveMods() const { return m_activeMods; }
+    const QStringList &getActiveMods() const { return m_activeMods.toStringList(); }
 
     // 获取已知的扩展包列表
     // 注意：knownExpansions仅包含官方DLC的packageId，不包含核心和创意工坊mod
@@ -55,7 +67,7 @@ public:
     // 设置已知扩展包列表（通常从原文件读取，不需要修改）
     void setKnownExpansions(const QStringList &expansions) { m_knownExpansions = expansions; }
 
-    // 设置激活的Mod列表
+    // 设置激活的Mod列表（重复项只保留第一次出现的）
     void setActiveMods(const QStringList &mods);
 
     // 从ModItem列表设置配置（自动区分activeMods和knownExpansions）
@@ -75,32 +87,44 @@ public:
 
     bool moveModToPosition(const QString &modId, int newPosition);
 
-    // 检查Mod是否激活
+    // 检查Mod是否激活（O(1)）
     bool isModActive(const QString &modId) const;
 
-    // 获取Mod在加载顺序中的位置
+    // 获取Mod在加载顺序中的位置（O(log n)），未激活时返回-1
     int getModPosition(const QString &modId) const;
 
     // 获取配置文件路径
     QString getConfigPath() const { return m_configPath; }
 
-    // 获取其他字段数据（用于完整保存文件）
-    QMap<QString, QString> getOtherFields() const { return m_otherFields; }
+    // 激活列表的修改代数（每次修改激活列表时递增，供校验结果判断是否过期）
+    quint64 getGeneration() const { return m_generation; }
+
+    // 获取其他字段的文本内容（嵌套元素只保留文本，用于另存为Mod列表）
+    QMap<QString, QString> getOtherFields() const;
+
+    // 把配置写入device（流式写入，不生成中间字符串）
+    bool writeXml(QIODevice *device) const;
 
     // 自动检测配置文件路径
     static QString getDefaultConfigPath();
 
 private:
+    // 未识别的顶层元素（原始XML字节，从 '<' 到对应的结束标签）
+    struct RawElement
+    {
+        QString name;
+        QByteArray xml;
+    };
+
     QString m_configPath;                 // 配置文件路径
     QString m_version;                    // 游戏版本
-    QStringList m_activeMods;             // 激活的Mod列表（按加载顺序）
+    ActiveModList m_activeMods;           // 激活的Mod列表（按加载顺序）
     QStringList m_knownExpansions;        // 已知的扩展包
-    QMap<QString, QString> m_otherFields; // 其他字段（保持原样）
+    QList<RawElement> m_otherFields;      // 其他字段（按原文件顺序，保持原样）
+    quint64 m_generation = 0;             // 激活列表的修改代数
 
     // 辅助方法
-    bool parseXml(const QString &xmlContent);
-
-    QString generateXml() const;
+    bool parseXml(const QByteArray &xmlContent);
 };
 
 #endif // MODCONFIGMANAGER_H
@@ -0,0 +1,331 @@
+#include "ModDependencyGraph.h"
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <algorithm>
+
+ModDependencyGraph::ModDependencyGraph(const QList<ModItem *> &mods)
+{
+    build(mods);
+}
+
+void ModDependencyGraph::build(const QList<ModItem *> &mods)
+{
+    // 节点按 PackageId 字母序排列，入度为0的节点按此顺序入队，保证排序结果稳定
+    QMap<QString, ModItem *> byPackageId;
+    quint32 idLimit = 0;
+    for (ModItem *mod : mods)
+    {
+        byPackageId[mod->packageId.toLower()] = mod;
+        if (mod->modId != INVALID_MOD_ID)
+        {
+            idLimit = qMax(idLimit, mod->modId + 1);
+        }
+    }
+    m_nodes = byPackageId.values();
+    const int n = int(m_nodes.size());
+
+    // 节点在输入列表中首次出现的位置，供按原顺序排序使用
+    QHash<const ModItem *, int> firstPosition;
+    firstPosition.reserve(mods.size());
+    for (int i = 0; i < mods.size(); ++i)
+    {
+        if (!firstPosition.contains(mods[i]))
+        {
+            firstPosition.insert(mods[i], i);
+        }
+    }
+    m_positions.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        m_positions[i] = firstPosition.value(m_nodes[i]);
+    }
+
+    // 整数ID到节点下标（不在图中的ID为-1）
+    QList<int> nodeOfId(idLimit, -1);
+    for (int i = 0; i < n; ++i)
+    {
+        const quint32 id = m_nodes[i]->modId;
+        if (id != INVALID_MOD_ID)
+        {
+            nodeOfId[id] = i;
+        }
+    }
+
+    auto nodeOf = [&nodeOfId](quint32 id)
+    {
+        return id < quint32(nodeOfId.size()) ? nodeOfId[id] : -1;
+    };
+
+    // 两遍扫描：第一遍统计出度，第二遍填充后继。
+    // 两遍按相同顺序（输入顺序，约束的声明顺序）访问边，后继顺序与逐条追加时一致
+    auto forEachEdge = [&](auto &&visit)
+    {
+        for (const ModItem *mod : mods)
+        {
+            const int self = nodeOf(mod->modId);
+            if (self < 0)
+            {
+                continue;
+            }
+
+            auto after = [&](const QList<quint32> &ids, ModEdgeKind kind)
+            {
+                for (quint32 id : ids)
+                {
+                    const int other = nodeOf(id);
+                    if (other >= 0)
+                        visit(other, self, kind);
+                }
+            };
+            auto before = [&](const QList<quint32> &ids, ModEdgeKind kind)
+            {
+                for (quint32 id : ids)
+                {
+                    const int other = nodeOf(id);
+                    if (other >= 0)
+                        visit(self, other, kind);
+                }
+            };
+
+            after(mod->dependencyIds, ModEdgeKind::Dependency);          // 依赖的Mod在前
+            after(mod->loadAfterIds, ModEdgeKind::LoadAfter);            // loadAfter 的Mod在前
+            before(mod->loadBeforeIds, ModEdgeKind::LoadBefore);         // loadBefore 的Mod在后
+            after(mod->forceLoadAfterIds, ModEdgeKind::ForceLoadAfter);  // 硬性约束
+            before(mod->forceLoadBeforeIds, ModEdgeKind::ForceLoadBefore); // 硬性约束
+        }
+    };
+
+    m_offsets.fill(0, n + 1);
+    m_inDegree.fill(0, n);
+    forEachEdge([this](int from, int to, ModEdgeKind)
+                {
+                    m_offsets[from + 1]++;
+                    m_inDegree[to]++;
+                });
+
+    for (int i = 0; i < n; ++i)
+    {
+        m_offsets[i + 1] += m_offsets[i];
+    }
+
+    m_targets.resize(m_offsets[n]);
+    m_edgeKinds.resize(m_offsets[n]);
+    QList<int> cursor(m_offsets.cbegin(), m_offsets.cend() - 1);
+    forEachEdge([this, &cursor](int from, int to, ModEdgeKind kind)
+                {
+                    const int edge = cursor[from]++;
+                    m_targets[edge] = to;
+                    m_edgeKinds[edge] = kind;
+                });
+
+    computeTopologicalOrder();
+    computeCycles();
+}
+
+void ModDependencyGraph::computeTopologicalOrder()
+{
+    const int n = int(m_nodes.size());
+    QList<int> remaining = m_inDegree;
+    m_order.clear();
+    m_order.reserve(n);
+
+    // 将所有入度为 0 的节点加入队列
+    for (int i = 0; i < n; ++i)
+    {
+        if (remaining[i] == 0)
+        {
+            m_order.append(i);
+        }
+    }
+
+    // 队首之前是已输出的节点，之后是待处理的节点
+    for (int head = 0; head < m_order.size(); ++head)
+    {
+        const int current = m_order[head];
+        for (const int *it = successorsBegin(current), *end = successorsEnd(current); it != end; ++it)
+        {
+            if (--remaining[*it] == 0)
+            {
+                m_order.append(*it);
+            }
+        }
+    }
+}
+
+void ModDependencyGraph::computeCycles()
+{
+    m_cycles.clear();
+    m_cyclicNodes.clear();
+    m_cycleIndexOf.clear();
+
+    // Kahn 已经排完所有节点时不可能有环
+    const int n = int(m_nodes.size());
+    if (m_order.size() == n)
+    {
+        return;
+    }
+
+    QList<int> index(n, -1);      // 访问序号
+    QList<int> lowLink(n, 0);
+    QList<bool> onStack(n, false);
+    QList<int> componentOf(n, -1); // 节点所属的分量编号
+    QList<int> stack;              // Tarjan 栈
+    QList<QPair<int, int>> callStack; // (节点, 下一条待访问的边)
+    int nextIndex = 0;
+    int componentCount = 0;
+    QList<int> cyclicComponentStarts; // 有环分量中字母序最小的节点
+
+    for (int root = 0; root < n; ++root)
+    {
+        if (index[root] != -1)
+        {
+            continue;
+        }
+
+        callStack.append({root, m_offsets[root]});
+        index[root] = lowLink[root] = nextIndex++;
+        stack.append(root);
+        onStack[root] = true;
+
+        while (!callStack.isEmpty())
+        {
+            auto &[node, edge] = callStack.last();
+            if (edge < m_offsets[node + 1])
+            {
+                const int next = m_targets[edge++];
+                if (index[next] == -1)
+                {
+                    index[next] = lowLink[next] = nextIndex++;
+                    stack.append(next);
+                    onStack[next] = true;
+                    callStack.append({next, m_offsets[next]}); // node/edge 引用在此之后失效
+                }
+                else if (onStack[next])
+                {
+                    lowLink[node] = qMin(lowLink[node], index[next]);
+                }
+                continue;
+            }
+
+            const int finished = node;
+            callStack.removeLast();
+            if (!callStack.isEmpty())
+            {
+                const int parent = callStack.last().first;
+                lowLink[parent] = qMin(lowLink[parent], lowLink[finished]);
+            }
+
+            if (lowLink[finished] != index[finished])
+            {
+                continue;
+            }
+
+            // finished 是分量的根，出栈得到整个分量
+            int member = -1;
+            int smallest = n;
+            int size = 0;
+            do
+            {
+                member = stack.takeLast();
+                onStack[member] = false;
+                componentOf[member] = componentCount;
+                smallest = qMin(smallest, member);
+                ++size;
+            } while (member != finished);
+
+            bool selfLoop = false;
+            if (size == 1)
+            {
+                selfLoop = std::find(successorsBegin(finished), successorsEnd(finished), finished) != successorsEnd(finished);
+            }
+            if (size > 1 || selfLoop)
+            {
+                cyclicComponentStarts.append(smallest);
+            }
+            ++componentCount;
+        }
+    }
+
+    // 按字母序输出
+    std::sort(cyclicComponentStarts.begin(), cyclicComponentStarts.end());
+    for (int start : cyclicComponentStarts)
+    {
+        m_cycles.append(shortestCycleThrough(start, componentOf));
+    }
+    QList<int> cycleOfComponent(componentCount, -1);
+    for (int i = 0; i < cyclicComponentStarts.size(); ++i)
+    {
+        cycleOfComponent[componentOf[cyclicComponentStarts[i]]] = i;
+    }
+    m_cycleIndexOf.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        m_cycleIndexOf[i] = cycleOfComponent[componentOf[i]];
+        if (m_cycleIndexOf[i] >= 0)
+        {
+            m_cyclicNodes.append(i);
+        }
+    }
+}
+
+ModCycle ModDependencyGraph::shortestCycleThrough(int start, const QList<int> &componentOf) const
+{
+    // 只在同一分量内搜索，记录每个节点的前驱节点和边
+    const int component = componentOf[start];
+    QHash<int, QPair<int, int>> parent; // 节点 -> (前驱, 边)
+    QList<int> queue{start};
+    int closingNode = -1;
+    int closingEdge = -1;
+
+    for (int head = 0; head < queue.size() && closingNode < 0; ++head)
+    {
+        const int current = queue[head];
+        for (int edge = m_offsets[current]; edge < m_offsets[current + 1]; ++edge)
+        {
+            const int next = m_targets[edge];
+            if (next == start)
+            {
+                closingNode = current;
+                closingEdge = edge;
+                break;
+            }
+            if (componentOf[next] == component && !parent.contains(next))
+            {
+                parent.insert(next, {current, edge});
+                queue.append(next);
+            }
+        }
+    }
+
+    ModCycle cycle;
+    if (closingNode < 0)
+    {
+        return cycle; // 分量内必然存在回路，不会到达这里
+    }
+
+    // 从闭合边倒推回 start
+    QList<int> nodes{closingNode};
+    QList<ModEdgeKind> kinds{m_edgeKinds[closingEdge]};
+    for (int node = closingNode; node != start;)
+    {
+        const QPair<int, int> step = parent.value(node);
+        nodes.prepend(step.first);
+        kinds.prepend(m_edgeKinds[step.second]);
+        node = step.first;
+    }
+
+    cycle.nodes = nodes;
+    cycle.kinds = kinds;
+    return cycle;
+}
+
+QStringList ModDependencyGraph::cyclicPackageIds() const
+{
+    QStringList packageIds;
+    for (int index : m_cyclicNodes)
+    {
+        packageIds.append(m_nodes[index]->packageId.toLower());
+    }
+    return packageIds;
+}
@@ -0,0 +1,117 @@
+#ifndef MODDEPENDENCYGRAPH_H
+#define MODDEPENDENCYGRAPH_H
+
+#include "ModItem.h"
+#include <QList>
+#include <QStringList>
+
+/**
+ * @brief 依赖图中边的来源约束
+ *
+ * After 类（Dependency/LoadAfter/ForceLoadAfter）由边的终点声明，
+ * Before 类（LoadBefore/ForceLoadBefore）由边的起点声明。
+ */
+enum class ModEdgeKind : quint8
+{
+    Dependency,
+    LoadAfter,
+    LoadBefore,
+    ForceLoadAfter,
+    ForceLoadBefore
+};
+
+// loadBefore/loadAfter 是可以放弃的软约束，依赖和 forceLoad* 是硬约束
+inline bool isSoftEdge(ModEdgeKind kind)
+{
+    return kind == ModEdgeKind::LoadBefore || kind == ModEdgeKind::LoadAfter;
+}
+
+/**
+ * @brief 一个具体的循环：nodes[i] -> nodes[i + 1]（最后一个节点回到第一个），kinds[i] 为对应边的约束类型
+ */
+struct ModCycle
+{
+    QList<int> nodes;
+    QList<ModEdgeKind> kinds;
+};
+
+/**
+ * @brief Mod 依赖图（压缩稀疏行存储）
+ *
+ * 节点为参与排序的 Mod，按 PackageId 字母序编号为 [0, nodeCount())。
+ * 边 a -> b 表示 a 必须在 b 之前加载，a 的所有后继存放在
+ * targets[offsets[a] .. offsets[a + 1]) 中，整张图只占用三个连续数组。
+ *
+ * 构建时执行一次 Kahn 拓扑排序和一次 Tarjan 强连通分量计算并保存结果，
+ * 排序、循环检测和循环查询都复用同一张图。传入的 Mod 必须已由 ModManager 分配整数ID。
+ */
+class ModDependencyGraph
+{
+public:
+    ModDependencyGraph() = default;
+    explicit ModDependencyGraph(const QList<ModItem *> &mods);
+
+    // 重新构建依赖图（清除之前的数据）
+    void build(const QList<ModItem *> &mods);
+
+    int nodeCount() const { return int(m_nodes.size()); }
+    int edgeCount() const { return int(m_targets.size()); }
+    ModItem *node(int index) const { return m_nodes.at(index); }
+
+    // 节点在构建时传入的列表中首次出现的位置
+    int inputPosition(int index) const { return m_positions.at(index); }
+
+    // 节点的后继（必须在该节点之后加载的节点）
+    const int *successorsBegin(int index) const { return m_targets.constData() + m_offsets.at(index); }
+    const int *successorsEnd(int index) const { return m_targets.constData() + m_offsets.at(index + 1); }
+
+    // 按全局下标访问边：节点的边为 [edgeBegin(index), edgeEnd(index))
+    int edgeBegin(int index) const { return m_offsets.at(index); }
+    int edgeEnd(int index) const { return m_offsets.at(index + 1); }
+    int edgeTarget(int edge) const { return m_targets.at(edge); }
+    ModEdgeKind edgeKind(int edge) const { return m_edgeKinds.at(edge); }
+
+    // 节点的入度
+    int inDegree(int index) const { return m_inDegree.at(index); }
+
+    // 拓扑序（节点下标）；存在循环依赖时只包含能够排序的节点
+    const QList<int> &topologicalOrder() const { return m_order; }
+
+    // 是否存在循环依赖
+    bool hasCycle() const { return !m_cycles.isEmpty(); }
+
+    // 每个包含循环的强连通分量给出一个具体循环（从分量中字母序最小的节点出发的最短回路）
+    const QList<ModCycle> &cycles() const { return m_cycles; }
+
+    // 节点所在的有环分量（cycles() 中的下标），不在循环中时返回-1
+    int cycleIndexOf(int index) const { return m_cycleIndexOf.isEmpty() ? -1 : m_cycleIndexOf.at(index); }
+
+    // 处于循环中的节点（按字母序，不包括只是依赖循环的下游节点）
+    const QList<int> &cyclicNodes() const { return m_cyclicNodes; }
+
+    // 处于循环中的节点的 PackageId（小写，按字母序）
+    QStringList cyclicPackageIds() const;
+
+private:
+    // Kahn 算法，拓扑序数组同时作为队列使用
+    void computeTopologicalOrder();
+
+    // Tarjan 强连通分量（迭代实现），为每个有环的分量找出一个具体循环
+    void computeCycles();
+
+    // 在强连通分量内从start出发，广度优先找回到start的最短回路
+    ModCycle shortestCycleThrough(int start, const QList<int> &componentOf) const;
+
+    QList<ModItem *> m_nodes;   // 节点下标到 Mod
+    QList<int> m_positions;     // 节点在输入列表中的位置
+    QList<int> m_offsets;       // 每个节点后继的起始位置（长度为节点数+1）
+    QList<int> m_targets;       // 所有节点的后继，按节点连续存放
+    QList<ModEdgeKind> m_edgeKinds; // 与 m_targets 对应的约束类型
+    QList<int> m_inDegree;      // 入度表
+    QList<int> m_order;         // 拓扑序
+    QList<ModCycle> m_cycles;   // 每个有环分量的一个具体循环
+    QList<int> m_cyclicNodes;   // 处于循环中的节点
+    QList<int> m_cycleIndexOf;  // 节点到有环分量下标（无环时为空）
+};
+
+#endif // MODDEPENDENCYGRAPH_H
@@ -0,0 +1,166 @@
+#include "ModDirectoryWatcher.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+ModDirectoryWatcher::ModDirectoryWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(1500);
+
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &ModDirectoryWatcher::onDirectoryChanged);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &ModDirectoryWatcher::onFileChanged);
+    connect(&m_debounceTimer, &QTimer::timeout, this, &ModDirectoryWatcher::flushPending);
+}
+
+void ModDirectoryWatcher::setRoots(const QStringList &rootPaths)
+{
+    clear();
+
+    QStringList paths;
+    for (const QString &root : rootPaths)
+    {
+        const QString rootPath = QDir::cleanPath(root);
+        if (rootPath.isEmpty() || !QDir(rootPath).exists())
+        {
+            continue;
+        }
+
+        paths.append(rootPath);
+
+        const QSet<QString> subdirs = listSubdirs(rootPath);
+        m_knownSubdirs.insert(rootPath, subdirs);
+
+        for (const QString &name : subdirs)
+        {
+            const QString aboutPath = aboutXmlPath(QDir(rootPath).absoluteFilePath(name));
+            if (QFile::exists(aboutPath))
+            {
+                paths.append(aboutPath);
+            }
+        }
+    }
+
+    if (!paths.isEmpty())
+    {
+        m_watcher.addPaths(paths);
+    }
+
+    qDebug() << "[ModDirectoryWatcher] Watching" << m_watcher.files().size() << "files in"
+             << m_watcher.directories().size() << "roots";
+}
+
+void ModDirectoryWatcher::clear()
+{
+    m_debounceTimer.stop();
+    m_pendingDirs.clear();
+    m_knownSubdirs.clear();
+
+    const QStringList files = m_watcher.files();
+    if (!files.isEmpty())
+    {
+        m_watcher.removePaths(files);
+    }
+    const QStringList dirs = m_watcher.directories();
+    if (!dirs.isEmpty())
+    {
+        m_watcher.removePaths(dirs);
+    }
+}
+
+void ModDirectoryWatcher::onDirectoryChanged(const QString &path)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    auto it = m_knownSubdirs.find(path);
+    if (it == m_knownSubdirs.end())
+    {
+        return;
+    }
+
+    // 对比一级子目录，新增和删除的目录都需要重扫
+    const QSet<QString> current = listSubdirs(path);
+    const QSet<QString> &known = it.value();
+
+    for (const QString &name : current)
+    {
+        if (!known.contains(name))
+        {
+            markDirty(QDir(path).absoluteFilePath(name));
+        }
+    }
+    for (const QString &name : known)
+    {
+        if (!current.contains(name))
+        {
+            markDirty(QDir(path).absoluteFilePath(name));
+        }
+    }
+
+    it.value() = current;
+}
+
+void ModDirectoryWatcher::onFileChanged(const QString &path)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    // {Mod目录}/About/About.xml -> {Mod目录}
+    QDir modDir = QFileInfo(path).dir();
+    modDir.cdUp();
+    markDirty(modDir.absolutePath());
+}
+
+void ModDirectoryWatcher::flushPending()
+{
+    if (m_pendingDirs.isEmpty())
+    {
+        return;
+    }
+
+    QStringList dirs(m_pendingDirs.begin(), m_pendingDirs.end());
+    m_pendingDirs.clear();
+    dirs.sort();
+
+    // 文件被替换后监视可能失效，重新添加仍存在的About.xml
+    QStringList watchedFiles = m_watcher.files();
+    QStringList toWatch;
+    for (const QString &dir : dirs)
+    {
+        const QString aboutPath = aboutXmlPath(dir);
+        if (QFile::exists(aboutPath) && !watchedFiles.contains(aboutPath))
+        {
+            toWatch.append(aboutPath);
+        }
+    }
+    if (!toWatch.isEmpty())
+    {
+        m_watcher.addPaths(toWatch);
+    }
+
+    emit modDirectoriesChanged(dirs);
+}
+
+QSet<QString> ModDirectoryWatcher::listSubdirs(const QString &rootPath)
+{
+    const QStringList entries = QDir(rootPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    return QSet<QString>(entries.begin(), entries.end());
+}
+
+QString ModDirectoryWatcher::aboutXmlPath(const QString &modDirPath)
+{
+    return QDir(modDirPath).absoluteFilePath("About/About.xml");
+}
+
+void ModDirectoryWatcher::markDirty(const QString &modDirPath)
+{
+    m_pendingDirs.insert(QDir::cleanPath(modDirPath));
+    m_debounceTimer.start();
+}
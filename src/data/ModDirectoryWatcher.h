@@ -0,0 +1,72 @@
+#ifndef MODDIRECTORYWATCHER_H
+#define MODDIRECTORYWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+/**
+ * @brief Mod目录变化监视器
+ *
+ * 监视扫描根目录（工坊目录和Data目录）及每个Mod的About/About.xml：
+ * - 根目录变化：对比一级子目录列表，找出新增或删除的Mod目录
+ * - About.xml变化：对应的Mod目录被标记为待重扫
+ *
+ * 变化会先进入待处理队列，静默一段时间后合并为一次 modDirectoriesChanged 信号，
+ * 避免Steam后台更新Mod时连续写入触发多次重扫。
+ */
+class ModDirectoryWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModDirectoryWatcher(QObject *parent = nullptr);
+
+    // 设置监视的根目录（会重建全部监视）
+    void setRoots(const QStringList &rootPaths);
+
+    // 停止监视并清空待处理队列
+    void clear();
+
+    // 暂停/恢复（暂停期间的变化会被丢弃，用于完整扫描期间）
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+
+    bool isEnabled() const { return m_enabled; }
+
+    // 设置合并变化的静默时间（毫秒）
+    void setDebounceInterval(int msec) { m_debounceTimer.setInterval(msec); }
+
+signals:
+    // 一批Mod目录发生变化（新增、修改或删除）
+    void modDirectoriesChanged(const QStringList &modDirPaths);
+
+private slots:
+    void onDirectoryChanged(const QString &path);
+
+    void onFileChanged(const QString &path);
+
+    void flushPending();
+
+private:
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounceTimer;
+    bool m_enabled = true;
+
+    QHash<QString, QSet<QString>> m_knownSubdirs; // 根目录 -> 已知的一级子目录名
+    QSet<QString> m_pendingDirs;                  // 待重扫的Mod目录
+
+    // 列出根目录下的一级子目录名
+    static QSet<QString> listSubdirs(const QString &rootPath);
+
+    // 获取Mod目录对应的About.xml路径
+    static QString aboutXmlPath(const QString &modDirPath);
+
+    // 标记Mod目录待重扫
+    void markDirty(const QString &modDirPath);
+};
+
+#endif // MODDIRECTORYWATCHER_H
@@ -1,4 +1,33 @@
 #include "ModItem.h"
+#include <QDataStream>
+#include <QRegularExpression>
+
+QStringList VersionedList::resolve(const QString &version) const
+{
+    if (byVersion.isEmpty())
+    {
+        return base; // 隐式共享，不复制
+    }
+
+    if (!version.isEmpty())
+    {
+        auto it = byVersion.constFind(version);
+        return it != byVersion.constEnd() ? it.value() : base;
+    }
+
+    QStringList merged = base;
+    for (const QStringList &items : byVersion)
+    {
+        for (const QString &item : items)
+        {
+            if (!merged.contains(item))
+            {
+                merged.append(item);
+            }
+        }
+    }
+    return merged;
+}
 
 void ModItem::addDependency(const QString &dependency)
 {
@@ -56,7 +85,94 @@ void ModItem::addSupportedVersion(const QString &version)
     }
 }
 
+void ModItem::setDescription(const QString &text)
+{
+    // 短描述压缩收益很小，直接保存UTF-8
+    constexpr qsizetype COMPRESS_THRESHOLD = 256;
+
+    QByteArray utf8 = text.toUtf8();
+    descriptionCompressed = false;
+
+    if (utf8.size() >= COMPRESS_THRESHOLD)
+    {
+        QByteArray compressed = qCompress(utf8);
+        if (compressed.size() < utf8.size())
+        {
+            descriptionData = std::move(compressed);
+            descriptionCompressed = true;
+            return;
+        }
+    }
+
+    descriptionData = std::move(utf8);
+}
+
+QString ModItem::getDescription() const
+{
+    if (descriptionCompressed)
+    {
+        return QString::fromUtf8(qUncompress(descriptionData));
+    }
+    return QString::fromUtf8(descriptionData);
+}
+
+void ModItem::applyGameVersion(const QString &version)
+{
+    dependencies = versionedDependencies.resolve(version);
+    loadBefore = versionedLoadBefore.resolve(version);
+    loadAfter = versionedLoadAfter.resolve(version);
+    incompatibleWith = versionedIncompatibleWith.resolve(version);
+}
+
+QString ModItem::toMajorMinorVersion(const QString &version)
+{
+    static const QRegularExpression pattern(QStringLiteral("^\\s*v?(\\d+)\\.(\\d+)"),
+                                            QRegularExpression::CaseInsensitiveOption);
+
+    QRegularExpressionMatch match = pattern.match(version);
+    if (!match.hasMatch())
+    {
+        return QString();
+    }
+    return match.captured(1) + '.' + match.captured(2);
+}
+
 bool ModItem::isValid() const
 {
     return !identifier.isEmpty();
 }
+
+QDataStream &operator<<(QDataStream &out, const VersionedList &list)
+{
+    out << list.base << list.byVersion;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, VersionedList &list)
+{
+    in >> list.base >> list.byVersion;
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const ModItem &mod)
+{
+    out << mod.identifier << mod.name << mod.descriptionData << mod.descriptionCompressed << mod.author << mod.url
+        << mod.packageId << mod.steamId << mod.supportedVersions
+        << mod.versionedDependencies << mod.versionedLoadBefore << mod.versionedLoadAfter
+        << mod.forceLoadBefore << mod.forceLoadAfter << mod.versionedIncompatibleWith
+        << mod.isOfficialDLC << mod.sourcePath;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, ModItem &mod)
+{
+    in >> mod.identifier >> mod.name >> mod.descriptionData >> mod.descriptionCompressed >> mod.author >> mod.url
+        >> mod.packageId >> mod.steamId >> mod.supportedVersions
+        >> mod.versionedDependencies >> mod.versionedLoadBefore >> mod.versionedLoadAfter
+        >> mod.forceLoadBefore >> mod.forceLoadAfter >> mod.versionedIncompatibleWith
+        >> mod.isOfficialDLC >> mod.sourcePath;
+
+    // 与解析结果一致，生效列表先取所有版本的并集，由ModManager按目标版本重新选择
+    mod.applyGameVersion(QString());
+    return in;
+}
@@ -1,9 +1,44 @@
 #ifndef MODITEM_H
 #define MODITEM_H
 
+#include <QByteArray>
+#include <QList>
+#include <QMap>
 #include <QString>
 #include <QStringList>
 
+class QDataStream;
+
+/**
+ * @brief 按游戏版本索引的约束列表（About.xml 中的 xxx 和 xxxByVersion）
+ *
+ * 没有版本块的Mod只占用base，byVersion为空（不分配）
+ */
+struct VersionedList
+{
+    QStringList base;                     // 不区分版本的列表
+    QMap<QString, QStringList> byVersion; // 版本号（major.minor，如"1.5"）到该版本的列表
+
+    bool isEmpty() const { return base.isEmpty() && byVersion.isEmpty(); }
+
+    // 选出指定版本实际生效的列表：存在该版本的块时替代base（与游戏的处理方式一致），
+    // 否则使用base；version为空时返回所有版本的并集
+    QStringList resolve(const QString &version) const;
+};
+
+// 无效的Mod整数ID（未分配或PackageId未知）
+constexpr quint32 INVALID_MOD_ID = 0xFFFFFFFFu;
+
+/**
+ * @brief Mod来源（同一PackageId出现在多个来源时，按 官方 > 本地 > 工坊 的优先级选择）
+ */
+enum class ModSource
+{
+    Workshop, // Steam创意工坊（任意Steam库）
+    Local,    // 游戏目录下的Mods文件夹
+    Official  // 游戏Data目录（核心和官方DLC）
+};
+
 /**
  * @brief Mod项数据结构
  *
@@ -13,7 +48,8 @@ struct ModItem
 {
     QString identifier;            // 唯一标识符（PackageId）
     QString name;                  // Mod名称
-    QString description;           // Mod描述
+    QByteArray descriptionData;    // Mod描述（UTF-8，较长时为qCompress压缩数据，通过setDescription/getDescription访问）
+    bool descriptionCompressed = false; // descriptionData是否为压缩数据
     QString author;                // 作者名
     QString url;                   // Mod链接
     QString packageId;             // 包ID（与identifier相同，保留以便扩展）
@@ -26,10 +62,27 @@ struct ModItem
     QStringList forceLoadAfter;    // 强制在这些Mod之后加载（硬性约束）
     QStringList incompatibleWith;  // 不兼容的Mod列表
 
+    // 整数ID（由ModManager的驻留表分配，不参与序列化）
+    // 各ID列表与对应的字符串列表一一对应（下标相同），排序和校验只比较整数
+    quint32 modId = INVALID_MOD_ID;
+    QList<quint32> dependencyIds;
+    QList<quint32> loadBeforeIds;
+    QList<quint32> loadAfterIds;
+    QList<quint32> forceLoadBeforeIds;
+    QList<quint32> forceLoadAfterIds;
+    QList<quint32> incompatibleWithIds;
+
+    // 按版本索引的原始约束，dependencies/loadBefore/loadAfter/incompatibleWith 由 applyGameVersion 从中选出
+    VersionedList versionedDependencies;
+    VersionedList versionedLoadBefore;
+    VersionedList versionedLoadAfter;
+    VersionedList versionedIncompatibleWith;
+
     QString remark;             // 备注
     QString type;               // Mod类型（如：核心、DLC、前置框架等）
     bool isOfficialDLC = false; // 是否为官方DLC（默认为false）
     QString sourcePath;         // Mod来源路径（用于区分工坊mod和官方DLC）
+    ModSource source = ModSource::Workshop; // Mod来源（由扫描器设置，不参与序列化）
 
     // 辅助方法
     void addDependency(const QString &dependency);
@@ -46,7 +99,48 @@ struct ModItem
 
     void addSupportedVersion(const QString &version);
 
+    // 设置描述（超过阈值时压缩保存，描述只在详情面板显示，不常驻为UTF-16文本）
+    void setDescription(const QString &text);
+
+    // 获取描述（每次调用都会解码/解压，界面应通过ModManager::getModDescription读取）
+    QString getDescription() const;
+
+    bool hasDescription() const { return !descriptionData.isEmpty(); }
+
+    // 按目标游戏版本重新选出生效的约束列表（version为空时使用所有版本的并集），无需重新扫描
+    void applyGameVersion(const QString &version);
+
+    // 提取版本号的 major.minor 部分（"1.5.4104 rev435" -> "1.5"，"v1.4" -> "1.4"），无法识别时返回空
+    static QString toMajorMinorVersion(const QString &version);
+
     bool isValid() const;
 };
 
+/**
+ * @brief 单个Mod目录增量重扫的结果
+ */
+struct ModDirectoryRescan
+{
+    enum Change
+    {
+        None,    // 无变化（目录不存在且此前也未扫描到）
+        Added,   // 新增Mod
+        Updated, // 已有Mod被重新解析（ModItem指针保持不变）
+        Removed  // Mod目录被删除或About.xml失效
+    };
+
+    Change change = None;
+    ModItem *mod = nullptr; // Added/Updated：当前对象；Removed：已移出扫描结果的对象（调用者负责删除）
+    QString oldPackageId;   // Updated/Removed：变化前的PackageId
+};
+
+// 二进制序列化（用于Mod解析缓存，不包含用户数据remark/type；约束只保存按版本索引的原始形式）
+QDataStream &operator<<(QDataStream &out, const ModItem &mod);
+
+QDataStream &operator>>(QDataStream &in, ModItem &mod);
+
+QDataStream &operator<<(QDataStream &out, const VersionedList &list);
+
+QDataStream &operator>>(QDataStream &in, VersionedList &list);
+
 #endif // MODITEM_H
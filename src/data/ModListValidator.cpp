@@ -0,0 +1,104 @@
+#include "ModListValidator.h"
+#include "ModConfigManager.h"
+#include "ModManager.h"
+
+ModListValidator::ModListValidator(ModConfigManager *configManager, ModManager *modManager)
+    : m_configManager(configManager), m_modManager(modManager)
+{
+}
+
+const ActiveOrderIndex &ModListValidator::validate()
+{
+    if (isStale())
+    {
+        m_index.reset(m_configManager->getActiveMods(), m_modManager);
+        markFresh();
+    }
+    return m_index;
+}
+
+bool ModListValidator::isStale() const
+{
+    return !m_valid || m_configGeneration != m_configManager->getGeneration() ||
+           m_modGeneration != m_modManager->getGeneration();
+}
+
+bool ModListValidator::addMod(const QString &packageId, QList<quint32> *changed)
+{
+    return insertMod(packageId, validate().size(), changed);
+}
+
+bool ModListValidator::insertMod(const QString &packageId, int position, QList<quint32> *changed)
+{
+    validate();
+    if (m_index.positionOf(packageId) >= 0)
+    {
+        return false;
+    }
+
+    position = qBound(0, position, m_index.size());
+    const quint64 generation = m_configManager->getGeneration();
+    m_configManager->insertMod(position, packageId);
+    if (m_configManager->getGeneration() == generation)
+    {
+        return false;
+    }
+
+    const QList<quint32> result = m_index.insert(position, packageId);
+    markFresh();
+    if (changed)
+    {
+        *changed = result;
+    }
+    return true;
+}
+
+bool ModListValidator::removeMod(const QString &packageId, QList<quint32> *changed)
+{
+    validate();
+    const int position = m_index.positionOf(packageId);
+    if (position < 0)
+    {
+        return false;
+    }
+
+    const quint64 generation = m_configManager->getGeneration();
+    m_configManager->removeMod(packageId);
+    if (m_configManager->getGeneration() == generation)
+    {
+        return false;
+    }
+
+    const QList<quint32> result = m_index.remove(position);
+    markFresh();
+    if (changed)
+    {
+        *changed = result;
+    }
+    return true;
+}
+
+bool ModListValidator::moveMod(const QString &packageId, int newPosition, QList<quint32> *changed)
+{
+    validate();
+    const int position = m_index.positionOf(packageId);
+    if (position < 0 || !m_configManager->moveModToPosition(packageId, newPosition))
+    {
+        return false;
+    }
+
+    const QList<quint32> result = m_index.move(position, newPosition);
+    markFresh();
+    if (changed)
+    {
+        *changed = result;
+    }
+    return true;
+}
+
+void ModListValidator::markFresh()
+{
+    m_configGeneration = m_configManager->getGeneration();
+    m_modGeneration = m_modManager->getGeneration();
+    m_valid = true;
+}
@@ -0,0 +1,47 @@
+#ifndef MODLISTVALIDATOR_H
+#define MODLISTVALIDATOR_H
+
+#include "ActiveOrderIndex.h"
+#include <QList>
+#include <QString>
+
+class ModConfigManager;
+class ModManager;
+
+/**
+ * @brief 激活列表校验器（缺失依赖、加载顺序、不兼容）
+ *
+ * 校验结果按 ModConfigManager 和 ModManager 的修改代数缓存：
+ * 两者都未变化时 validate() 直接返回缓存结果，否则一次遍历重新校验整个列表（O(n+e)）。
+ * 通过本类执行的单次编辑会同时修改配置和增量更新校验结果，不会触发完整校验。
+ */
+class ModListValidator
+{
+public:
+    ModListValidator(ModConfigManager *configManager, ModManager *modManager);
+
+    // 获取最新的校验结果（过期时重新校验）
+    const ActiveOrderIndex &validate();
+
+    // 缓存的校验结果是否已过期
+    bool isStale() const;
+
+    // 编辑激活列表（同时修改ModConfigManager），成功时通过changed返回校验结果变化的Mod ID
+    bool addMod(const QString &packageId, QList<quint32> *changed = nullptr);
+    bool insertMod(const QString &packageId, int position, QList<quint32> *changed = nullptr);
+    bool removeMod(const QString &packageId, QList<quint32> *changed = nullptr);
+    bool moveMod(const QString &packageId, int newPosition, QList<quint32> *changed = nullptr);
+
+private:
+    // 编辑完成后记录当前代数（结果已经增量更新，不需要重新校验）
+    void markFresh();
+
+    ModConfigManager *m_configManager;
+    ModManager *m_modManager;
+    ActiveOrderIndex m_index;
+    quint64 m_configGeneration = 0;
+    quint64 m_modGeneration = 0;
+    bool m_valid = false;
+};
+
+#endif // MODLISTVALIDATOR_H
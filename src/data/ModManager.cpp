@@ -1,14 +1,46 @@
 #include "ModManager.h"
+#include "PersistenceService.h"
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace {
+    // 描述LRU缓存容量（字符数），约可容纳几十个长描述
+    constexpr qsizetype DESCRIPTION_CACHE_MAX_COST = 256 * 1024;
+
+    bool isScanCancelled(const ScanProgress *progress) {
+        return progress && progress->isCancelled();
+    }
+
+    // 来源优先级，数值越小优先级越高
+    int sourcePriority(ModSource source) {
+        switch (source) {
+            case ModSource::Official:
+                return 0;
+            case ModSource::Local:
+                return 1;
+            case ModSource::Workshop:
+                return 2;
+        }
+        return 2;
+    }
+}
 
 ModManager::ModManager()
     : m_workshopScanner(new WorkshopScanner()),
       m_dlcScanner(new OfficialDLCScanner()),
-      m_userDataManager(new UserDataManager()) {
+      m_catalogCache(new ModCatalogCache()),
+      m_catalogCacheEnabled(true),
+      m_userDataManager(new UserDataManager()),
+      m_descriptionCache(DESCRIPTION_CACHE_MAX_COST) {
     // 初始化用户数据目录
     UserDataManager::initializeDirectories();
 
+    // 扫描器共享解析缓存
+    setCatalogCacheEnabled(true);
+
     // 加载用户数据
     m_userDataManager->loadAll();
 }
@@ -17,53 +49,55 @@ ModManager::ModManager(const QString &steamPath)
     : m_steamPath(steamPath),
       m_workshopScanner(new WorkshopScanner()),
       m_dlcScanner(new OfficialDLCScanner()),
-      m_userDataManager(new UserDataManager()) {
+      m_catalogCache(new ModCatalogCache()),
+      m_catalogCacheEnabled(true),
+      m_userDataManager(new UserDataManager()),
+      m_descriptionCache(DESCRIPTION_CACHE_MAX_COST) {
     // 初始化用户数据目录
     UserDataManager::initializeDirectories();
 
+    // 扫描器共享解析缓存
+    setCatalogCacheEnabled(true);
+
     // 加载用户数据
     m_userDataManager->loadAll();
 
-    // 设置工坊路径
-    QString workshopPath = QDir(steamPath).absoluteFilePath("steamapps/workshop/content/294100");
-    m_workshopScanner->setWorkshopPath(workshopPath);
+    // 设置工坊路径（包括libraryfolders.vdf中的其他Steam库）
+    m_workshopScanner->setWorkshopPaths(WorkshopScanner::findWorkshopPaths(steamPath));
 
     // 默认游戏安装路径（假设在Steam标准位置）
-    m_gameInstallPath = QDir(steamPath).absoluteFilePath("steamapps/common/RimWorld");
-
-    // 设置DLC路径
-    QString dataPath = OfficialDLCScanner::getDefaultDataPath(m_gameInstallPath);
-    m_dlcScanner->setDataPath(dataPath);
+    setGameInstallPath(QDir(steamPath).absoluteFilePath("steamapps/common/RimWorld"));
 }
 
 ModManager::~ModManager() {
-    // 在销毁前保存用户数据
+    // 在销毁前保存用户数据（Mod数据快照只排队一次），并等待所有排队的异步写入完成
     saveModsToUserData();
-    m_userDataManager->saveAll();
+    m_userDataManager->saveTypes();
+    m_userDataManager->saveTypePriority();
+    PersistenceService::instance().flush();
 
     // 删除扫描器
     delete m_workshopScanner;
     delete m_dlcScanner;
+    delete m_catalogCache;
     delete m_userDataManager;
 
     // 清理缓存的Mod对象（扫描器内部的对象已被清理）
     m_cachedWorkshopMods.clear();
     m_cachedOfficialDLCs.clear();
     m_packageIdMap.clear();
+    m_duplicateMods.clear();
+    m_descriptionCache.clear();
 }
 
 void ModManager::setSteamPath(const QString &steamPath) {
     m_steamPath = steamPath;
 
-    // 更新扫描器路径
-    QString workshopPath = QDir(steamPath).absoluteFilePath("steamapps/workshop/content/294100");
-    m_workshopScanner->setWorkshopPath(workshopPath);
+    // 更新扫描器路径（包括libraryfolders.vdf中的其他Steam库）
+    m_workshopScanner->setWorkshopPaths(WorkshopScanner::findWorkshopPaths(steamPath));
 
     // 默认游戏安装路径（假设在Steam标准位置）
-    m_gameInstallPath = QDir(steamPath).absoluteFilePath("steamapps/common/RimWorld");
-
-    QString dataPath = OfficialDLCScanner::getDefaultDataPath(m_gameInstallPath);
-    m_dlcScanner->setDataPath(dataPath);
+    setGameInstallPath(QDir(steamPath).absoluteFilePath("steamapps/common/RimWorld"));
 }
 
 void ModManager::setGameInstallPath(const QString &gameInstallPath) {
@@ -72,15 +106,62 @@ void ModManager::setGameInstallPath(const QString &gameInstallPath) {
     // 更新DLC扫描器路径
     QString dataPath = OfficialDLCScanner::getDefaultDataPath(gameInstallPath);
     m_dlcScanner->setDataPath(dataPath);
+
+    // 本地Mod目录（{游戏安装路径}/Mods）
+    m_workshopScanner->setLocalModsPath(gameInstallPath.isEmpty() ? QString()
+                                                                  : QDir(gameInstallPath).absoluteFilePath("Mods"));
 }
 
-bool ModManager::scanAll() {
+bool ModManager::scanAll(ScanProgress *progress) {
     // 清除旧数据
     clear();
 
-    // 扫描工坊Mod和官方DLC
-    bool workshopSuccess = scanWorkshopMods();
-    bool dlcSuccess = scanOfficialDLCs();
+    // 映射解析缓存，未变化的About.xml直接从缓存反序列化
+    if (m_catalogCacheEnabled) {
+        m_catalogCache->load();
+    }
+
+    // 官方DLC与工坊/本地Mod同时扫描（工坊扫描器内部再按设备分组并行）
+    QFuture<bool> dlcScan = QtConcurrent::run([this, progress]() {
+        return m_dlcScanner->scanAllDLCs(progress);
+    });
+    bool workshopSuccess = m_workshopScanner->scanAllMods(progress);
+    bool dlcSuccess = dlcScan.result();
+
+    // 被取消时丢弃已扫描的部分结果，也不写回缓存（磁盘上的缓存文件保持不变）。
+    // 这是最后一次检查，之后到达的取消请求不再生效，扫描结果照常保留
+    if (isScanCancelled(progress)) {
+        clear();
+        if (m_catalogCacheEnabled) {
+            m_catalogCache->clear();
+        }
+        progress->markCancelled();
+        qDebug() << "[ModManager] Scan cancelled";
+        return false;
+    }
+
+    // 两个扫描器都结束后再统一建立映射
+    if (workshopSuccess) {
+        m_cachedWorkshopMods = m_workshopScanner->getScannedMods();
+    }
+    if (dlcSuccess) {
+        m_cachedOfficialDLCs = m_dlcScanner->getScannedDLCs();
+    }
+
+    // 按目标游戏版本选出生效的约束列表，并转换为整数ID（建立映射时据此生成反向依赖索引）
+    for (ModItem *mod: getAllMods()) {
+        prepareModConstraints(mod);
+    }
+    rebuildPackageIdMap();
+    qDebug() << "[ModManager] Scanned" << m_cachedWorkshopMods.size() << "workshop/local mods and"
+            << m_cachedOfficialDLCs.size() << "official DLCs";
+
+    // 写回本次扫描的条目（已删除的Mod会被清理）
+    if (m_catalogCacheEnabled) {
+        qDebug() << "[ModManager] Catalog cache hits:" << m_catalogCache->getHitCount()
+                << "misses:" << m_catalogCache->getMissCount();
+        m_catalogCache->save();
+    }
 
     // 从UserDataManager加载备注和类型到ModItem
     loadUserDataToMods();
@@ -88,18 +169,16 @@ bool ModManager::scanAll() {
     return workshopSuccess || dlcSuccess;
 }
 
-bool ModManager::scanWorkshopMods() {
+bool ModManager::scanWorkshopMods(ScanProgress *progress) {
     // 使用扫描器扫描
-    bool success = m_workshopScanner->scanAllMods();
+    bool success = m_workshopScanner->scanAllMods(progress);
 
     if (success) {
         // 缓存扫描结果
         m_cachedWorkshopMods = m_workshopScanner->getScannedMods();
 
-        // 更新PackageId映射
-        for (ModItem *mod: m_cachedWorkshopMods) {
-            m_packageIdMap[mod->packageId] = mod;
-        }
+        // 更新PackageId映射（按来源优先级处理重复）
+        rebuildPackageIdMap();
 
         qDebug() << "[ModManager] Scanned" << m_cachedWorkshopMods.size() << "workshop mods";
     }
@@ -107,18 +186,16 @@ bool ModManager::scanWorkshopMods() {
     return success;
 }
 
-bool ModManager::scanOfficialDLCs() {
+bool ModManager::scanOfficialDLCs(ScanProgress *progress) {
     // 使用扫描器扫描
-    bool success = m_dlcScanner->scanAllDLCs();
+    bool success = m_dlcScanner->scanAllDLCs(progress);
 
     if (success) {
         // 缓存扫描结果
         m_cachedOfficialDLCs = m_dlcScanner->getScannedDLCs();
 
-        // 更新PackageId映射
-        for (ModItem *dlc: m_cachedOfficialDLCs) {
-            m_packageIdMap[dlc->packageId] = dlc;
-        }
+        // 更新PackageId映射（按来源优先级处理重复）
+        rebuildPackageIdMap();
 
         qDebug() << "[ModManager] Scanned" << m_cachedOfficialDLCs.size() << "official DLCs";
     }
@@ -126,6 +203,109 @@ bool ModManager::scanOfficialDLCs() {
     return success;
 }
 
+ModRescanSummary ModManager::rescanModDirectories(const QStringList &modDirPaths) {
+    ModRescanSummary summary;
+    QList<ModItem *> removedMods;
+
+    const QStringList modRoots = m_workshopScanner->getModRoots();
+    const QString dataRoot = QDir::cleanPath(m_dlcScanner->getDataPath());
+
+    for (const QString &path: modDirPaths) {
+        const QString modDirPath = QDir::cleanPath(path);
+        const QString rootPath = QFileInfo(modDirPath).path();
+
+        // 根据所在根目录交给对应的扫描器（工坊目录和本地Mods目录都由工坊扫描器处理）
+        ModDirectoryRescan result;
+        if (modRoots.contains(rootPath)) {
+            result = m_workshopScanner->rescanModDirectory(modDirPath);
+        } else if (!dataRoot.isEmpty() && rootPath == dataRoot) {
+            result = m_dlcScanner->rescanDLCDirectory(modDirPath);
+        } else {
+            continue;
+        }
+
+        ModItem *mod = result.mod;
+        switch (result.change) {
+            case ModDirectoryRescan::Added:
+                prepareModConstraints(mod);
+                applyUserData(mod);
+                summary.added.append(mod->packageId);
+                break;
+            case ModDirectoryRescan::Updated:
+                m_descriptionCache.remove(mod);
+                prepareModConstraints(mod);
+                applyUserData(mod);
+                summary.updated.append(mod->packageId);
+                break;
+            case ModDirectoryRescan::Removed:
+                m_descriptionCache.remove(mod);
+                // 解析缓存以来源目录为键，不再写回已删除的Mod
+                m_catalogCache->remove(mod->sourcePath);
+                removedMods.append(mod);
+                summary.removed.append(result.oldPackageId);
+                break;
+            case ModDirectoryRescan::None:
+                break;
+        }
+    }
+
+    if (!summary.isEmpty()) {
+        // 同步缓存列表（扫描器已原地更新自身的列表），再按来源优先级重建映射
+        m_cachedWorkshopMods = m_workshopScanner->getScannedMods();
+        m_cachedOfficialDLCs = m_dlcScanner->getScannedDLCs();
+        rebuildPackageIdMap();
+    }
+
+    // 最后再释放已删除的Mod，此时缓存中已没有它们的指针
+    qDeleteAll(removedMods);
+
+    qDebug() << "[ModManager] Incremental rescan:" << summary.added.size() << "added,"
+            << summary.updated.size() << "updated," << summary.removed.size() << "removed";
+
+    return summary;
+}
+
+QStringList ModManager::getWatchRoots() const {
+    QStringList roots = m_workshopScanner->getModRoots();
+    if (!m_dlcScanner->getDataPath().isEmpty()) {
+        roots.append(m_dlcScanner->getDataPath());
+    }
+    return roots;
+}
+
+void ModManager::setGameVersion(const QString &gameVersion) {
+    const QString version = ModItem::toMajorMinorVersion(gameVersion);
+    if (version == m_gameVersion) {
+        return;
+    }
+
+    m_gameVersion = version;
+    for (ModItem *mod: getAllMods()) {
+        prepareModConstraints(mod);
+    }
+    rebuildConstraintIndexes();
+    ++m_generation;
+
+    qDebug() << "[ModManager] Target game version:" << (m_gameVersion.isEmpty() ? "all" : m_gameVersion);
+}
+
+void ModManager::setParallelScan(bool enabled) {
+    m_workshopScanner->setParallelScan(enabled);
+    m_dlcScanner->setParallelScan(enabled);
+}
+
+void ModManager::setCatalogCacheEnabled(bool enabled) {
+    m_catalogCacheEnabled = enabled;
+
+    ModCatalogCache *cache = enabled ? m_catalogCache : nullptr;
+    m_workshopScanner->setCatalogCache(cache);
+    m_dlcScanner->setCatalogCache(cache);
+
+    if (!enabled) {
+        m_catalogCache->clear();
+    }
+}
+
 QList<ModItem *> ModManager::getAllMods() const {
     QList<ModItem *> allMods;
 
@@ -150,11 +330,99 @@ ModItem *ModManager::findModByPackageId(const QString &packageId) const {
     return m_packageIdMap.value(packageId, nullptr);
 }
 
+quint32 ModManager::internPackageId(const QString &packageId) {
+    const QString key = packageId.toLower();
+    auto it = m_modIds.constFind(key);
+    if (it != m_modIds.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = quint32(m_internedPackageIds.size());
+    m_modIds.insert(key, id);
+    m_internedPackageIds.append(key);
+    return id;
+}
+
+quint32 ModManager::findModId(const QString &packageId) const {
+    // 大多数PackageId已经是小写，先直接查找，避免toLower分配
+    auto it = m_modIds.constFind(packageId);
+    if (it == m_modIds.constEnd()) {
+        it = m_modIds.constFind(packageId.toLower());
+    }
+    return it != m_modIds.constEnd() ? it.value() : INVALID_MOD_ID;
+}
+
+QString ModManager::getPackageIdById(quint32 id) const {
+    return id < quint32(m_internedPackageIds.size()) ? m_internedPackageIds.at(id) : QString();
+}
+
+ModItem *ModManager::findModById(quint32 id) const {
+    return id < quint32(m_modsById.size()) ? m_modsById.at(id) : nullptr;
+}
+
+const QList<quint32> &ModManager::getDependentIds(quint32 id, ModDependentKind kind) const {
+    static const QList<quint32> empty;
+    const QList<QList<quint32>> &dependents = m_dependents[int(kind)];
+    return id < quint32(dependents.size()) ? dependents.at(id) : empty;
+}
+
+const QList<quint32> &ModManager::getConflictIds(quint32 id) const {
+    static const QList<quint32> empty;
+    return id < quint32(m_conflicts.size()) ? m_conflicts.at(id) : empty;
+}
+
+QString modDependentKindLabel(ModDependentKind kind) {
+    switch (kind) {
+        case ModDependentKind::Dependency:
+            return QStringLiteral("依赖");
+        case ModDependentKind::ForceLoadAfter:
+            return QStringLiteral("强制前置");
+        case ModDependentKind::LoadAfter:
+            return QStringLiteral("建议前置");
+    }
+    return QString();
+}
+
+QList<ModItem *> ModManager::getDependents(const QString &packageId, ModDependentKind kind) const {
+    QList<ModItem *> mods;
+    for (quint32 id: getDependentIds(findModId(packageId), kind)) {
+        if (ModItem *mod = findModById(id)) {
+            mods.append(mod);
+        }
+    }
+    return mods;
+}
+
+QList<ModItem *> ModManager::getModsByPackageId(const QString &packageId) const {
+    auto it = m_duplicateMods.constFind(packageId);
+    if (it != m_duplicateMods.constEnd()) {
+        return it.value();
+    }
+
+    ModItem *mod = findModByPackageId(packageId);
+    return mod ? QList<ModItem *>{mod} : QList<ModItem *>();
+}
+
 bool ModManager::isOfficialDLC(const QString &packageId) const {
     ModItem *mod = findModByPackageId(packageId);
     return mod && mod->isOfficialDLC;
 }
 
+QString ModManager::getModDescription(const ModItem *mod) const {
+    if (!mod) {
+        return QString();
+    }
+
+    if (const QString *cached = m_descriptionCache.object(mod)) {
+        return *cached;
+    }
+
+    QString description = mod->getDescription();
+    // 成本至少为1，空描述也占一个位置
+    m_descriptionCache.insert(mod, new QString(description), qMax<qsizetype>(1, description.size()));
+    return description;
+}
+
 void ModManager::loadUserDataToMods() {
     int loadedCount = 0;
 
@@ -162,28 +430,143 @@ void ModManager::loadUserDataToMods() {
     QList<ModItem *> allMods = getAllMods();
 
     for (ModItem *mod: allMods) {
-        if (!mod)
+        loadedCount += applyUserData(mod);
+    }
+
+    qDebug() << "[ModManager] Loaded user data to" << loadedCount << "fields across" << allMods.size() << "mods";
+}
+
+int ModManager::applyUserData(ModItem *mod) {
+    if (!mod)
+        return 0;
+
+    int loadedCount = 0;
+
+    // 从UserDataManager加载类型
+    QString type = m_userDataManager->getModType(mod->packageId);
+    if (!type.isEmpty()) {
+        mod->type = type;
+        loadedCount++;
+    }
+
+    // 从UserDataManager加载备注
+    QString remark = m_userDataManager->getModRemark(mod->packageId);
+    if (!remark.isEmpty()) {
+        mod->remark = remark;
+        loadedCount++;
+    }
+
+    return loadedCount;
+}
+
+void ModManager::prepareModConstraints(ModItem *mod) {
+    mod->applyGameVersion(m_gameVersion);
+
+    auto internAll = [this](const QStringList &packageIds) {
+        QList<quint32> ids;
+        ids.reserve(packageIds.size());
+        for (const QString &packageId: packageIds) {
+            ids.append(internPackageId(packageId));
+        }
+        return ids;
+    };
+
+    mod->modId = internPackageId(mod->packageId);
+    mod->dependencyIds = internAll(mod->dependencies);
+    mod->loadBeforeIds = internAll(mod->loadBefore);
+    mod->loadAfterIds = internAll(mod->loadAfter);
+    mod->forceLoadBeforeIds = internAll(mod->forceLoadBefore);
+    mod->forceLoadAfterIds = internAll(mod->forceLoadAfter);
+    mod->incompatibleWithIds = internAll(mod->incompatibleWith);
+}
+
+void ModManager::rebuildPackageIdMap() {
+    m_packageIdMap.clear();
+    m_duplicateMods.clear();
+    m_modsById.clear();
+    ++m_generation;
+
+    // 按来源优先级排列（官方 > 本地 > 工坊），同一来源内保持扫描顺序
+    QList<ModItem *> ordered = getAllMods();
+    std::stable_sort(ordered.begin(), ordered.end(), [](const ModItem *a, const ModItem *b) {
+        return sourcePriority(a->source) < sourcePriority(b->source);
+    });
+
+    for (ModItem *mod: ordered) {
+        auto it = m_packageIdMap.constFind(mod->packageId);
+        if (it == m_packageIdMap.constEnd()) {
+            m_packageIdMap.insert(mod->packageId, mod);
+
+            mod->modId = internPackageId(mod->packageId);
+            if (mod->modId >= quint32(m_modsById.size())) {
+                m_modsById.resize(mod->modId + 1, nullptr);
+            }
+            m_modsById[mod->modId] = mod;
             continue;
+        }
 
-        // 从UserDataManager加载类型
-        QString type = m_userDataManager->getModType(mod->packageId);
-        if (!type.isEmpty()) {
-            mod->type = type;
-            loadedCount++;
+        mod->modId = internPackageId(mod->packageId);
+
+        // 重复的PackageId：映射保留优先级最高的Mod，全部来源记录在m_duplicateMods中
+        QList<ModItem *> &duplicates = m_duplicateMods[mod->packageId];
+        if (duplicates.isEmpty()) {
+            duplicates.append(it.value());
         }
+        duplicates.append(mod);
+    }
 
-        // 从UserDataManager加载备注
-        QString remark = m_userDataManager->getModRemark(mod->packageId);
-        if (!remark.isEmpty()) {
-            mod->remark = remark;
-            loadedCount++;
+    for (auto it = m_duplicateMods.cbegin(); it != m_duplicateMods.cend(); ++it) {
+        QStringList paths;
+        for (const ModItem *mod: it.value()) {
+            paths.append(mod->sourcePath);
         }
+        qWarning() << "[ModManager] Duplicate packageId" << it.key() << "found in:" << paths;
     }
 
-    qDebug() << "[ModManager] Loaded user data to" << loadedCount << "fields across" << allMods.size() << "mods";
+    rebuildConstraintIndexes();
+}
+
+void ModManager::rebuildConstraintIndexes() {
+    const int idCount = getModIdCount();
+    for (QList<QList<quint32>> &dependents: m_dependents) {
+        dependents.clear();
+        dependents.resize(idCount);
+    }
+    m_conflicts.clear();
+    m_conflicts.resize(idCount);
+
+    // 只索引每个PackageId优先级最高的Mod，与findModById的结果一致
+    for (const ModItem *mod: m_modsById) {
+        if (!mod) {
+            continue;
+        }
+
+        auto index = [this, mod](const QList<quint32> &targets, ModDependentKind kind) {
+            QList<QList<quint32>> &dependents = m_dependents[int(kind)];
+            for (quint32 target: targets) {
+                // 同一个Mod的追加是连续的，检查末尾即可去重
+                QList<quint32> &list = dependents[target];
+                if (target != mod->modId && (list.isEmpty() || list.last() != mod->modId)) {
+                    list.append(mod->modId);
+                }
+            }
+        };
+        index(mod->dependencyIds, ModDependentKind::Dependency);
+        index(mod->forceLoadAfterIds, ModDependentKind::ForceLoadAfter);
+        index(mod->loadAfterIds, ModDependentKind::LoadAfter);
+
+        // 不兼容关系双向记录，只有一方声明时两边都能查到
+        for (quint32 target: mod->incompatibleWithIds) {
+            if (target == mod->modId || m_conflicts[mod->modId].contains(target)) {
+                continue;
+            }
+            m_conflicts[mod->modId].append(target);
+            m_conflicts[target].append(mod->modId);
+        }
+    }
 }
 
-void ModManager::saveModsToUserData() {
+QFuture<bool> ModManager::saveModsToUserData() {
     int savedCount = 0;
 
     // 遍历所有缓存的Mod
@@ -208,8 +591,15 @@ void ModManager::saveModsToUserData() {
 
     qDebug() << "[ModManager] Saved" << savedCount << "user data fields from" << allMods.size() << "mods";
 
-    // 持久化到文件
-    m_userDataManager->saveModData();
+    // 持久化到文件（工作线程中写入）
+    return m_userDataManager->saveModDataAsync();
+}
+
+bool ModManager::saveModUserData(const ModItem *mod) {
+    if (!mod)
+        return false;
+
+    return m_userDataManager->updateModUserData(mod->packageId, mod->type, mod->remark);
 }
 
 void ModManager::clear() {
@@ -221,4 +611,16 @@ void ModManager::clear() {
     m_cachedWorkshopMods.clear();
     m_cachedOfficialDLCs.clear();
     m_packageIdMap.clear();
+    m_duplicateMods.clear();
+    m_descriptionCache.clear();
+
+    // 所有ModItem都已释放，ID可以重新分配
+    m_modIds.clear();
+    m_internedPackageIds.clear();
+    m_modsById.clear();
+    for (QList<QList<quint32>> &dependents: m_dependents) {
+        dependents.clear();
+    }
+    m_conflicts.clear();
+    ++m_generation;
 }
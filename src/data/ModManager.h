@@ -1,14 +1,51 @@
 #ifndef MODMANAGER_H
 #define MODMANAGER_H
 
+#include "ModCatalogCache.h"
 #include "ModItem.h"
 #include "OfficialDLCScanner.h"
+#include "ScanProgress.h"
 #include "UserDataManager.h"
 #include "WorkshopScanner.h"
+#include <QCache>
+#include <QFuture>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QString>
 
+/**
+ * @brief 增量重扫结果（PackageId列表）
+ */
+struct ModRescanSummary
+{
+    QStringList added;   // 新增的Mod
+    QStringList updated; // 重新解析的Mod（ModItem指针保持不变）
+    QStringList removed; // 已删除的Mod（对应的ModItem已释放）
+
+    bool isEmpty() const { return added.isEmpty() && updated.isEmpty() && removed.isEmpty(); }
+    int count() const { return added.size() + updated.size() + removed.size(); }
+};
+
+/**
+ * @brief 反向依赖的约束类型（按依赖强度排列）
+ */
+enum class ModDependentKind
+{
+    Dependency,     // modDependencies
+    ForceLoadAfter, // forceLoadAfter
+    LoadAfter       // loadAfter
+};
+
+constexpr int MOD_DEPENDENT_KIND_COUNT = 3;
+
+// 全部约束类型（从强到弱）
+constexpr ModDependentKind MOD_DEPENDENT_KINDS[MOD_DEPENDENT_KIND_COUNT] = {
+    ModDependentKind::Dependency, ModDependentKind::ForceLoadAfter, ModDependentKind::LoadAfter};
+
+// 约束类型的显示名称（如"依赖"）
+QString modDependentKindLabel(ModDependentKind kind);
+
 /**
  * @brief Mod管理器（中心管理类）
  *
@@ -38,33 +75,95 @@ public:
 
     // ==================== Mod扫描和缓存 ====================
 
-    // 扫描所有Mod（包括工坊mod和官方DLC）
+    // 扫描所有Mod（包括所有Steam库的工坊mod、本地Mods目录和官方DLC，各来源同时扫描）
     // 扫描后自动从UserDataManager加载备注和类型，并更新到ModItem
-    bool scanAll();
+    // progress不为空时，扫描线程持续发布进度和解析完成的Mod快照，供界面逐步显示；
+    // 通过progress取消时丢弃全部部分结果（ModManager处于清空状态）并返回false
+    bool scanAll(ScanProgress *progress = nullptr);
 
     // 单独扫描工坊Mod
-    bool scanWorkshopMods();
+    bool scanWorkshopMods(ScanProgress *progress = nullptr);
 
     // 单独扫描官方DLC
-    bool scanOfficialDLCs();
+    bool scanOfficialDLCs(ScanProgress *progress = nullptr);
+
+    // 增量重扫指定的Mod目录（工坊或Data下的一级目录），原地更新缓存和映射
+    // 不会调用clear()，未变化的ModItem指针保持有效；已删除Mod的ModItem会被释放
+    ModRescanSummary rescanModDirectories(const QStringList &modDirPaths);
+
+    // 获取需要监视的扫描根目录（所有工坊目录、本地Mods目录和Data目录）
+    QStringList getWatchRoots() const;
+
+    // 设置目标游戏版本（如ModConfigManager::getVersion()），立即按该版本重新选出所有Mod的约束列表
+    // 版本为空或无法识别时使用所有版本的并集
+    void setGameVersion(const QString &gameVersion);
+    QString getGameVersion() const { return m_gameVersion; }
+
+    // 设置是否并行解析About.xml（同时作用于工坊扫描器和DLC扫描器）
+    void setParallelScan(bool enabled);
+
+    // 设置是否使用解析缓存（UserData/catalog.cache，默认开启）
+    void setCatalogCacheEnabled(bool enabled);
+    bool isCatalogCacheEnabled() const { return m_catalogCacheEnabled; }
 
     // ==================== 缓存数据访问 ====================
 
     // 获取所有Mod（从缓存）
     QList<ModItem *> getAllMods() const;
 
-    // 获取工坊Mod（从缓存）
+    // 获取工坊Mod和本地Mod（从缓存）
     QList<ModItem *> getWorkshopMods() const;
 
     // 获取官方DLC（从缓存）
     QList<ModItem *> getOfficialDLCs() const;
 
     // 根据PackageId查找Mod（从缓存）
+    // 同一PackageId出现在多个来源时，按 官方 > 本地 > 工坊 的优先级返回
     ModItem *findModByPackageId(const QString &packageId) const;
 
+    // 获取同一PackageId的所有Mod（优先级最高的在前）
+    QList<ModItem *> getModsByPackageId(const QString &packageId) const;
+
+    // 获取出现在多个来源中的PackageId
+    QStringList getDuplicatePackageIds() const { return m_duplicateMods.keys(); }
+
     // 检查Mod是否为官方DLC
     bool isOfficialDLC(const QString &packageId) const;
 
+    // ==================== 整数ID（PackageId驻留表） ====================
+    // 扫描时为每个PackageId（不区分大小写）分配一个稠密的32位ID，范围为 [0, getModIdCount())
+    // 约束中引用但未安装的PackageId同样分配ID；clear()后ID重新分配
+
+    // 获取PackageId对应的ID，不存在时分配新ID
+    quint32 internPackageId(const QString &packageId);
+
+    // 查找PackageId对应的ID，不存在时返回INVALID_MOD_ID
+    quint32 findModId(const QString &packageId) const;
+
+    // 获取ID对应的PackageId（小写）
+    QString getPackageIdById(quint32 id) const;
+
+    // 根据ID查找Mod（重复时为优先级最高的Mod），未安装时返回nullptr
+    ModItem *findModById(quint32 id) const;
+
+    // 已分配的ID数量
+    int getModIdCount() const { return int(m_internedPackageIds.size()); }
+
+    // 对id声明了指定约束的已安装Mod的ID（反向依赖索引，同一PackageId只计优先级最高的Mod）
+    const QList<quint32> &getDependentIds(quint32 id, ModDependentKind kind) const;
+
+    // 对packageId声明了指定约束的已安装Mod
+    QList<ModItem *> getDependents(const QString &packageId, ModDependentKind kind) const;
+
+    // 与id不兼容的Mod的ID（对称：任意一方在incompatibleWith中声明了另一方即视为冲突）
+    const QList<quint32> &getConflictIds(quint32 id) const;
+
+    // Mod数据的修改代数（扫描、增量重扫、切换游戏版本后递增，此时ID和约束可能已变化）
+    quint64 getGeneration() const { return m_generation; }
+
+    // 获取Mod描述（解压结果保存在LRU缓存中，重复查看同一Mod时不再解压）
+    QString getModDescription(const ModItem *mod) const;
+
     // ==================== UserDataManager联动 ====================
 
     // 获取UserDataManager（用于外部访问用户数据）
@@ -74,8 +173,11 @@ public:
     // 从UserDataManager加载备注和类型到所有缓存的ModItem
     void loadUserDataToMods();
 
-    // 将所有缓存的ModItem的备注和类型保存到UserDataManager
-    void saveModsToUserData();
+    // 将所有缓存的ModItem的备注和类型保存到UserDataManager，并异步写入文件（连续调用会合并为一次写入）
+    QFuture<bool> saveModsToUserData();
+
+    // 保存单个Mod的备注和类型（只追加日志，不重写整个数据文件），返回是否有变化
+    bool saveModUserData(const ModItem *mod);
 
     // ==================== 清理 ====================
 
@@ -83,21 +185,52 @@ public:
     void clear();
 
 private:
+    // 从UserDataManager加载单个Mod的备注和类型，返回加载的字段数
+    int applyUserData(ModItem *mod);
+
+    // 按来源优先级重建PackageId映射，并记录重复的PackageId
+    void rebuildPackageIdMap();
+
+    // 按目标游戏版本选出约束列表，并生成对应的整数ID列表
+    void prepareModConstraints(ModItem *mod);
+
+    // 按当前生效的约束ID列表重建反向依赖索引和冲突索引
+    void rebuildConstraintIndexes();
+
     // 路径
     QString m_steamPath;       // Steam安装路径
     QString m_gameInstallPath; // 游戏安装路径
+    QString m_gameVersion;     // 目标游戏版本（major.minor）
 
     // 扫描器（私有服务，仅供ModManager使用）
     WorkshopScanner *m_workshopScanner; // 工坊扫描器
     OfficialDLCScanner *m_dlcScanner;   // DLC扫描器
 
+    // 解析缓存
+    ModCatalogCache *m_catalogCache; // About.xml解析缓存
+    bool m_catalogCacheEnabled;      // 是否启用解析缓存
+
     // 用户数据管理器
     UserDataManager *m_userDataManager; // 用户数据管理器
 
     // 缓存数据
-    QList<ModItem *> m_cachedWorkshopMods;   // 缓存的工坊Mod列表
+    QList<ModItem *> m_cachedWorkshopMods;   // 缓存的工坊Mod和本地Mod列表
     QList<ModItem *> m_cachedOfficialDLCs;   // 缓存的官方DLC列表
-    QMap<QString, ModItem *> m_packageIdMap; // PackageId到Mod的统一映射
+    QMap<QString, ModItem *> m_packageIdMap; // PackageId到Mod的统一映射（重复时为优先级最高的Mod）
+    QMap<QString, QList<ModItem *>> m_duplicateMods; // 重复的PackageId到所有来源的Mod
+
+    // PackageId驻留表
+    QHash<QString, quint32> m_modIds;    // 小写PackageId到ID
+    QStringList m_internedPackageIds;    // ID到小写PackageId
+    QList<ModItem *> m_modsById;         // ID到Mod（未安装的为nullptr）
+
+    // 反向依赖索引：按约束类型，ID到声明了该约束的已安装Mod的ID
+    QList<QList<quint32>> m_dependents[MOD_DEPENDENT_KIND_COUNT];
+    QList<QList<quint32>> m_conflicts; // 冲突索引：ID到与之不兼容的Mod的ID（对称）
+    quint64 m_generation = 0;            // Mod数据的修改代数
+
+    // 最近查看的Mod描述（成本按字符数计算）
+    mutable QCache<const ModItem *, QString> m_descriptionCache;
 };
 
 #endif // MODMANAGER_H
@@ -1,7 +1,9 @@
 #include "ModSorter.h"
 #include <QDebug>
-#include <QQueue>
-#include <QSet>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
 
 ModSorter::ModSorter()
 {
@@ -14,301 +16,439 @@ QList<ModItem *> ModSorter::sortMods(const QList<ModItem *> &mods, const QString
         return mods;
     }
 
-    // 1. 构建依赖关系图
-    QMap<QString, QStringList> graph;
-    QMap<QString, int> inDegree;
-    buildDependencyGraph(mods, graph, inDegree);
+    return sortMods(ModDependencyGraph(mods), typePriority);
+}
 
-    // 2. 拓扑排序
-    QList<ModItem *> sorted = topologicalSort(mods, graph, inDegree);
+QList<ModItem *> ModSorter::sortMods(const ModDependencyGraph &graph, const QStringList &typePriority,
+                                     QStringList *droppedHints, QList<bool> *cycleResolved)
+{
+    const int n = graph.nodeCount();
+    const QHash<QString, int> typeRanks = buildTypeRanks(typePriority);
 
-    // 3. 在满足依赖的前提下，按类型优先级调整
-    if (!typePriority.isEmpty())
+    // 有环时先放弃一部分软约束，其余约束按原样参与排序
+    const QList<bool> dropped = relaxSoftConstraints(graph);
+    if (droppedHints)
     {
-        sorted = stabilizeSortByTypePriority(sorted, typePriority);
+        droppedHints->clear();
+        for (int node = 0; node < n; ++node)
+        {
+            for (int edge = graph.edgeBegin(node); edge < graph.edgeEnd(node); ++edge)
+            {
+                if (dropped[edge])
+                {
+                    droppedHints->append(describeEdge(graph, node, graph.edgeTarget(edge), graph.edgeKind(edge)));
+                }
+            }
+        }
     }
 
-    return sorted;
-}
+    // 排序键：类型优先级（未设置的类型最低），相同时保持原位置
+    struct ReadyNode
+    {
+        int rank;
+        int position;
+        int node;
 
-void ModSorter::buildDependencyGraph(const QList<ModItem *> &mods,
-                                     QMap<QString, QStringList> &outGraph,
-                                     QMap<QString, int> &outInDegree)
-{
-    // 创建 packageId 到 ModItem 的映射
-    QMap<QString, ModItem *> modMap;
-    for (ModItem *mod : mods)
+        bool operator>(const ReadyNode &other) const
+        {
+            return rank != other.rank ? rank > other.rank : position > other.position;
+        }
+    };
+
+    QList<ReadyNode> keys(n);
+    QList<int> inDegree(n, 0);
+    for (int i = 0; i < n; ++i)
     {
-        QString id = mod->packageId.toLower();
-        modMap[id] = mod;
-        outInDegree[id] = 0;
-        outGraph[id] = QStringList();
+        keys[i] = {typeRanks.value(graph.node(i)->type, int(typePriority.size())), graph.inputPosition(i), i};
+        for (int edge = graph.edgeBegin(i); edge < graph.edgeEnd(i); ++edge)
+        {
+            if (!dropped[edge])
+            {
+                inDegree[graph.edgeTarget(edge)]++;
+            }
+        }
     }
 
-    // 构建依赖关系
-    for (ModItem *mod : mods)
+    std::priority_queue<ReadyNode, std::vector<ReadyNode>, std::greater<ReadyNode>> ready;
+    for (int i = 0; i < n; ++i)
     {
-        QString modId = mod->packageId.toLower();
+        if (inDegree[i] == 0)
+        {
+            ready.push(keys[i]);
+        }
+    }
 
-        // 处理 dependencies（mod 依赖这些包）
-        for (const QString &dep : mod->dependencies)
+    QList<ModItem *> sorted;
+    sorted.reserve(n);
+    while (!ready.empty())
+    {
+        const int current = ready.top().node;
+        ready.pop();
+        sorted.append(graph.node(current));
+
+        for (int edge = graph.edgeBegin(current); edge < graph.edgeEnd(current); ++edge)
         {
-            QString depId = dep.toLower();
-            if (modMap.contains(depId))
+            if (!dropped[edge] && --inDegree[graph.edgeTarget(edge)] == 0)
             {
-                // depId 必须在 modId 之前
-                outGraph[depId].append(modId);
-                outInDegree[modId]++;
+                ready.push(keys[graph.edgeTarget(edge)]);
             }
         }
+    }
+
+    // 只看分量内保留的边再做一次 Kahn：剩下的节点所在分量仍有循环。
+    // 不能直接看上面的排序结果，排在其他无法打破的循环之后的分量同样不会被排出
+    if (cycleResolved)
+    {
+        cycleResolved->fill(true, graph.cycles().size());
+        auto isKeptInternal = [&](int from, int edge)
+        {
+            const int cycle = graph.cycleIndexOf(from);
+            return !dropped[edge] && cycle >= 0 && cycle == graph.cycleIndexOf(graph.edgeTarget(edge));
+        };
 
-        // 处理 loadAfter（mod 要在这些包之后加载）
-        for (const QString &after : mod->loadAfter)
+        QList<int> internalInDegree(n, 0);
+        for (int node : graph.cyclicNodes())
         {
-            QString afterId = after.toLower();
-            if (modMap.contains(afterId))
+            for (int edge = graph.edgeBegin(node); edge < graph.edgeEnd(node); ++edge)
             {
-                // afterId 必须在 modId 之前
-                outGraph[afterId].append(modId);
-                outInDegree[modId]++;
+                if (isKeptInternal(node, edge))
+                {
+                    internalInDegree[graph.edgeTarget(edge)]++;
+                }
             }
         }
 
-        // 处理 loadBefore（mod 要在这些包之前加载）
-        for (const QString &before : mod->loadBefore)
+        QList<int> queue;
+        for (int node : graph.cyclicNodes())
         {
-            QString beforeId = before.toLower();
-            if (modMap.contains(beforeId))
+            if (internalInDegree[node] == 0)
             {
-                // modId 必须在 beforeId 之前
-                outGraph[modId].append(beforeId);
-                outInDegree[beforeId]++;
+                queue.append(node);
             }
         }
-
-        // 处理 forceLoadAfter（mod 强制在这些包之后加载，硬性约束）
-        for (const QString &after : mod->forceLoadAfter)
+        for (int head = 0; head < queue.size(); ++head)
         {
-            QString afterId = after.toLower();
-            if (modMap.contains(afterId))
+            const int node = queue[head];
+            for (int edge = graph.edgeBegin(node); edge < graph.edgeEnd(node); ++edge)
             {
-                // afterId 必须在 modId 之前
-                outGraph[afterId].append(modId);
-                outInDegree[modId]++;
+                if (isKeptInternal(node, edge) && --internalInDegree[graph.edgeTarget(edge)] == 0)
+                {
+                    queue.append(graph.edgeTarget(edge));
+                }
             }
         }
 
-        // 处理 forceLoadBefore（mod 强制在这些包之前加载，硬性约束）
-        for (const QString &before : mod->forceLoadBefore)
+        for (int node : graph.cyclicNodes())
         {
-            QString beforeId = before.toLower();
-            if (modMap.contains(beforeId))
+            if (internalInDegree[node] > 0)
             {
-                // modId 必须在 beforeId 之前
-                outGraph[modId].append(beforeId);
-                outInDegree[beforeId]++;
+                (*cycleResolved)[graph.cycleIndexOf(node)] = false;
             }
         }
     }
-}
 
-QList<ModItem *> ModSorter::topologicalSort(const QList<ModItem *> &mods,
-                                            const QMap<QString, QStringList> &graph,
-                                            QMap<QString, int> inDegree)
-{
-    // 创建 packageId 到 ModItem 的映射
-    QMap<QString, ModItem *> modMap;
-    for (ModItem *mod : mods)
+    // 存在循环依赖时，将未排序的节点也加入结果（虽然顺序可能不正确）
+    if (sorted.size() != n)
     {
-        modMap[mod->packageId.toLower()] = mod;
+        qWarning() << "检测到无法打破的硬约束循环，无法完全排序";
+        QList<ReadyNode> remaining;
+        for (int i = 0; i < n; ++i)
+        {
+            if (inDegree[i] > 0)
+            {
+                remaining.append(keys[i]);
+            }
+        }
+        std::sort(remaining.begin(), remaining.end(), [](const ReadyNode &a, const ReadyNode &b)
+                  { return b > a; });
+        for (const ReadyNode &entry : remaining)
+        {
+            sorted.append(graph.node(entry.node));
+        }
     }
 
-    QList<ModItem *> result;
-    QQueue<QString> queue;
+    return sorted;
+}
 
-    // 将所有入度为 0 的节点加入队列
-    for (auto it = inDegree.begin(); it != inDegree.end(); ++it)
+QHash<QString, int> ModSorter::buildTypeRanks(const QStringList &typePriority)
+{
+    QHash<QString, int> ranks;
+    for (int i = 0; i < typePriority.size(); ++i)
     {
-        if (it.value() == 0)
+        // 列表中重复的类型以第一次出现为准
+        if (!ranks.contains(typePriority[i]))
         {
-            queue.enqueue(it.key());
+            ranks.insert(typePriority[i], i);
         }
     }
+    return ranks;
+}
 
-    // Kahn 算法
-    while (!queue.isEmpty())
+QList<bool> ModSorter::relaxSoftConstraints(const ModDependencyGraph &graph)
+{
+    const int n = graph.nodeCount();
+    QList<bool> dropped(graph.edgeCount(), false);
+    if (!graph.hasCycle())
     {
-        QString current = queue.dequeue();
-        result.append(modMap[current]);
+        return dropped;
+    }
 
-        // 遍历所有依赖 current 的节点
-        for (const QString &neighbor : graph[current])
+    // 只考虑两端在同一有环分量内的边，分量之间的边不会构成循环
+    auto isInternal = [&graph](int from, int to)
+    {
+        const int cycle = graph.cycleIndexOf(from);
+        return cycle >= 0 && cycle == graph.cycleIndexOf(to);
+    };
+
+    QList<QList<int>> incoming(n); // 分量内的入边（边下标）
+    QList<int> outDegree(n, 0);
+    QList<int> inDegree(n, 0);
+    QList<int> hardInDegree(n, 0);
+    for (int node = 0; node < n; ++node)
+    {
+        for (int edge = graph.edgeBegin(node); edge < graph.edgeEnd(node); ++edge)
         {
-            inDegree[neighbor]--;
-            if (inDegree[neighbor] == 0)
-            {
-                queue.enqueue(neighbor);
-            }
+            const int target = graph.edgeTarget(edge);
+            if (!isInternal(node, target))
+                continue;
+            incoming[target].append(edge);
+            outDegree[node]++;
+            inDegree[target]++;
+            if (!isSoftEdge(graph.edgeKind(edge)))
+                hardInDegree[target]++;
         }
     }
 
-    // 如果结果数量不等于输入数量，说明存在循环依赖
-    if (result.size() != mods.size())
+    QList<int> sourceOf(graph.edgeCount(), -1); // 边下标到起点
+    for (int node = 0; node < n; ++node)
     {
-        qWarning() << "检测到循环依赖，无法完全排序";
-        // 将未排序的节点也加入结果（虽然顺序可能不正确）
-        for (ModItem *mod : mods)
+        for (int edge = graph.edgeBegin(node); edge < graph.edgeEnd(node); ++edge)
         {
-            if (!result.contains(mod))
-            {
-                result.append(mod);
-            }
+            sourceOf[edge] = node;
         }
     }
 
-    return result;
-}
+    // Eades-Lin-Smyth：反复取出汇点（放到末尾）和源点（放到开头），
+    // 都没有时取出 出度-入度 最大的节点放到开头。为了不违反硬约束，
+    // 只在没有硬约束入边的节点中挑选；只有硬约束循环时才退回到全部节点
+    QList<int> rankOf(n, -1);
+    QList<bool> removed(n, false);
 
-int ModSorter::getTypePriority(const QString &type, const QStringList &typePriority)
-{
-    int index = typePriority.indexOf(type);
-    if (index >= 0)
+    struct Candidate
     {
-        return index;
-    }
-    // 未在优先级列表中的类型，优先级最低
-    return 99999;
-}
+        int hardFree; // 没有硬约束入边时为1
+        int delta;    // 出度-入度
+        int position; // 原位置，越小越优先
+        int node;
 
-QList<ModItem *> ModSorter::stabilizeSortByTypePriority(const QList<ModItem *> &mods,
-                                                        const QStringList &typePriority)
-{
-    QList<ModItem *> result = mods;
+        bool operator<(const Candidate &other) const
+        {
+            if (hardFree != other.hardFree)
+                return hardFree < other.hardFree;
+            if (delta != other.delta)
+                return delta < other.delta;
+            return position > other.position;
+        }
+    };
+
+    auto candidateOf = [&](int node) -> Candidate
+    {
+        return {hardInDegree[node] == 0 ? 1 : 0, outDegree[node] - inDegree[node], graph.inputPosition(node), node};
+    };
 
-    // 使用冒泡排序的思想，但只交换不破坏依赖关系的相邻元素
-    bool swapped = true;
-    while (swapped)
+    for (int cycle = 0; cycle < graph.cycles().size(); ++cycle)
     {
-        swapped = false;
-        for (int i = 0; i < result.size() - 1; i++)
+        QList<int> members;
+        for (int node : graph.cyclicNodes())
         {
-            ModItem *mod1 = result[i];
-            ModItem *mod2 = result[i + 1];
+            if (graph.cycleIndexOf(node) == cycle)
+                members.append(node);
+        }
 
-            int priority1 = getTypePriority(mod1->type, typePriority);
-            int priority2 = getTypePriority(mod2->type, typePriority);
+        QList<int> front; // 依次放到开头的节点
+        QList<int> back;  // 依次放到末尾的节点（倒序）
+        QList<int> sinks;
+        QList<int> sources;
+        std::priority_queue<Candidate> candidates; // 延迟删除：弹出时与当前状态比较
+        for (int node : members)
+        {
+            if (outDegree[node] == 0)
+                sinks.append(node);
+            else if (inDegree[node] == 0)
+                sources.append(node);
+            candidates.push(candidateOf(node));
+        }
 
-            // 如果 mod2 优先级更高且可以安全交换，则交换
-            if (priority2 < priority1 && canSwap(mod1, mod2))
+        auto remove = [&](int node)
+        {
+            removed[node] = true;
+            for (int edge = graph.edgeBegin(node); edge < graph.edgeEnd(node); ++edge)
             {
-                result.swapItemsAt(i, i + 1);
-                swapped = true;
+                const int target = graph.edgeTarget(edge);
+                if (!isInternal(node, target) || removed[target])
+                    continue;
+                inDegree[target]--;
+                if (!isSoftEdge(graph.edgeKind(edge)))
+                    hardInDegree[target]--;
+                if (inDegree[target] == 0)
+                    sources.append(target);
+                candidates.push(candidateOf(target));
             }
-        }
-    }
+            for (int edge : incoming[node])
+            {
+                const int source = sourceOf[edge];
+                if (removed[source])
+                    continue;
+                outDegree[source]--;
+                if (outDegree[source] == 0)
+                    sinks.append(source);
+                candidates.push(candidateOf(source));
+            }
+        };
 
-    return result;
-}
+        int remaining = int(members.size());
+        while (remaining > 0)
+        {
+            if (!sinks.isEmpty())
+            {
+                const int node = sinks.takeLast();
+                if (!removed[node])
+                {
+                    back.append(node);
+                    remove(node);
+                    --remaining;
+                }
+                continue;
+            }
+            if (!sources.isEmpty())
+            {
+                const int node = sources.takeLast();
+                if (!removed[node])
+                {
+                    front.append(node);
+                    remove(node);
+                    --remaining;
+                }
+                continue;
+            }
 
-bool ModSorter::canSwap(ModItem *mod1, ModItem *mod2)
-{
-    QString id1 = mod1->packageId.toLower();
-    QString id2 = mod2->packageId.toLower();
+            const Candidate best = candidates.top();
+            candidates.pop();
+            if (removed[best.node])
+                continue;
+            const Candidate current = candidateOf(best.node);
+            if (current.hardFree != best.hardFree || current.delta != best.delta)
+                continue; // 过期条目，新状态已重新入队
+            front.append(best.node);
+            remove(best.node);
+            --remaining;
+        }
 
-    // 检查 mod1 是否依赖 mod2
-    for (const QString &dep : mod1->dependencies)
-    {
-        if (dep.toLower() == id2)
-            return false;
-    }
-    for (const QString &after : mod1->loadAfter)
-    {
-        if (after.toLower() == id2)
-            return false;
+        int rank = 0;
+        for (int node : front)
+            rankOf[node] = rank++;
+        for (auto it = back.crbegin(); it != back.crend(); ++it)
+            rankOf[*it] = rank++;
     }
 
-    // 检查 mod2 是否必须在 mod1 之前
-    for (const QString &before : mod1->loadBefore)
+    // 与上面的顺序方向相反的软约束边即为候选放弃集合
+    QList<int> candidatesToDrop;
+    for (int node = 0; node < n; ++node)
     {
-        if (before.toLower() == id2)
-            return false;
+        for (int edge = graph.edgeBegin(node); edge < graph.edgeEnd(node); ++edge)
+        {
+            const int target = graph.edgeTarget(edge);
+            if (isInternal(node, target) && isSoftEdge(graph.edgeKind(edge)) && rankOf[target] <= rankOf[node])
+            {
+                dropped[edge] = true;
+                candidatesToDrop.append(edge);
+            }
+        }
     }
 
-    // 检查 mod2 是否依赖 mod1（如果是，不能交换）
-    for (const QString &dep : mod2->dependencies)
+    // 贪心顺序可能放弃过多：逐条尝试恢复，只要恢复后不形成新的回路就保留该约束
+    QList<int> visitMark(n, -1);
+    for (int i = 0; i < candidatesToDrop.size(); ++i)
     {
-        if (dep.toLower() == id1)
-            return false;
-    }
-    for (const QString &before : mod2->loadBefore)
-    {
-        if (before.toLower() == id1)
-            return false;
-    }
-    for (const QString &after : mod2->loadAfter)
-    {
-        if (after.toLower() == id1)
-            return false;
+        const int edge = candidatesToDrop[i];
+        const int from = sourceOf[edge];
+        const int to = graph.edgeTarget(edge);
+
+        // 从 to 出发沿保留的分量内边搜索，能回到 from 说明恢复后会成环
+        bool reachesFrom = (from == to);
+        QList<int> queue{to};
+        visitMark[to] = i;
+        for (int head = 0; head < queue.size() && !reachesFrom; ++head)
+        {
+            const int current = queue[head];
+            for (int next = graph.edgeBegin(current); next < graph.edgeEnd(current); ++next)
+            {
+                const int target = graph.edgeTarget(next);
+                if (dropped[next] || !isInternal(current, target) || visitMark[target] == i)
+                    continue;
+                if (target == from)
+                {
+                    reachesFrom = true;
+                    break;
+                }
+                visitMark[target] = i;
+                queue.append(target);
+            }
+        }
+
+        if (!reachesFrom)
+        {
+            dropped[edge] = false;
+        }
     }
 
-    return true;
+    return dropped;
 }
 
 bool ModSorter::hasCircularDependency(const QList<ModItem *> &mods)
 {
-    QMap<QString, QStringList> graph;
-    QMap<QString, int> inDegree;
-    buildDependencyGraph(mods, graph, inDegree);
-
-    QList<ModItem *> sorted = topologicalSort(mods, graph, inDegree);
-    return sorted.size() != mods.size();
+    return ModDependencyGraph(mods).hasCycle();
 }
 
 QStringList ModSorter::getCircularDependencies(const QList<ModItem *> &mods)
 {
-    QMap<QString, QStringList> graph;
-    QMap<QString, int> inDegree;
-    buildDependencyGraph(mods, graph, inDegree);
-
-    // 创建副本用于修改
-    QMap<QString, int> inDegreeCopy = inDegree;
-    QSet<QString> visited;
-    QQueue<QString> queue;
+    return ModDependencyGraph(mods).cyclicPackageIds();
+}
 
-    // 将所有入度为 0 的节点加入队列
-    for (auto it = inDegreeCopy.begin(); it != inDegreeCopy.end(); ++it)
+QList<QStringList> ModSorter::describeCycles(const ModDependencyGraph &graph)
+{
+    QList<QStringList> descriptions;
+    for (const ModCycle &cycle : graph.cycles())
     {
-        if (it.value() == 0)
+        QStringList edges;
+        for (int i = 0; i < cycle.nodes.size(); ++i)
         {
-            queue.enqueue(it.key());
+            const int from = cycle.nodes[i];
+            const int to = cycle.nodes[(i + 1) % cycle.nodes.size()];
+            edges.append(describeEdge(graph, from, to, cycle.kinds[i]));
         }
+        descriptions.append(edges);
     }
+    return descriptions;
+}
 
-    // 移除所有可以拓扑排序的节点
-    while (!queue.isEmpty())
-    {
-        QString current = queue.dequeue();
-        visited.insert(current);
-
-        for (const QString &neighbor : graph[current])
-        {
-            inDegreeCopy[neighbor]--;
-            if (inDegreeCopy[neighbor] == 0)
-            {
-                queue.enqueue(neighbor);
-            }
-        }
-    }
+QString ModSorter::describeEdge(const ModDependencyGraph &graph, int from, int to, ModEdgeKind kind)
+{
+    const QString first = graph.node(from)->packageId;
+    const QString second = graph.node(to)->packageId;
 
-    // 剩下的节点就是循环依赖的节点
-    QStringList circular;
-    for (auto it = inDegreeCopy.begin(); it != inDegreeCopy.end(); ++it)
+    switch (kind)
     {
-        if (it.value() > 0)
-        {
-            circular.append(it.key());
-        }
+    case ModEdgeKind::Dependency:
+        return QString("%1 依赖 %2 (modDependencies)").arg(second, first);
+    case ModEdgeKind::LoadAfter:
+        return QString("%1 要求在 %2 之后加载 (loadAfter)").arg(second, first);
+    case ModEdgeKind::ForceLoadAfter:
+        return QString("%1 强制在 %2 之后加载 (forceLoadAfter)").arg(second, first);
+    case ModEdgeKind::LoadBefore:
+        return QString("%1 要求在 %2 之前加载 (loadBefore)").arg(first, second);
+    case ModEdgeKind::ForceLoadBefore:
+        return QString("%1 强制在 %2 之前加载 (forceLoadBefore)").arg(first, second);
     }
-
-    return circular;
+    return QString();
 }
@@ -1,9 +1,10 @@
 #ifndef MODSORTER_H
 #define MODSORTER_H
 
+#include "ModDependencyGraph.h"
 #include "ModItem.h"
+#include <QHash>
 #include <QList>
-#include <QMap>
 #include <QString>
 #include <QStringList>
 
@@ -14,6 +15,15 @@
  * 排序优先级：
  * 1. Mod 之间的依赖关系（dependencies/loadBefore/loadAfter）
  * 2. 用户设置的类型优先级
+ * 3. Mod 在输入列表中的原顺序
+ *
+ * 排序为一次 Kahn 拓扑排序，就绪节点从按（类型优先级, 原位置）排序的优先队列中取出，
+ * 得到满足全部约束的字典序最小的顺序，复杂度 O((n+e) log n)。
+ *
+ * 依赖图以 ModManager 分配的整数ID（ModItem::modId 及各约束的 *Ids 列表）建立，
+ * 排序过程中不再比较或转换 PackageId 字符串。传入的 Mod 必须已由 ModManager 分配ID。
+ *
+ * 需要同时排序和检查循环依赖时，先构建一次 ModDependencyGraph，再调用接受图的重载。
  */
 class ModSorter
 {
@@ -29,11 +39,26 @@ public:
      *
      * 算法流程：
      * 1. 构建依赖关系图
-     * 2. 拓扑排序解决依赖约束
-     * 3. 在满足依赖的前提下，按类型优先级调整顺序
+     * 2. 拓扑排序，每次从所有依赖已满足的 Mod 中取类型优先级最高、原位置最靠前的一个
      */
     static QList<ModItem *> sortMods(const QList<ModItem *> &mods, const QStringList &typePriority);
 
+    /**
+     * @brief 使用已构建的依赖图排序
+     *
+     * 存在循环时，依赖和 forceLoad* 视为硬约束，loadBefore/loadAfter 视为软约束：
+     * 先用贪心反馈边集启发式（Eades-Lin-Smyth）为每个有环分量选出尽量少的软约束放弃，
+     * 再按剩余约束排序。只由硬约束构成的循环无法打破，其中的 Mod 追加在末尾。
+     *
+     * @param graph 依赖图
+     * @param typePriority 类型优先级列表（从高到低）
+     * @param droppedHints 输出：被放弃的软约束描述，可为空
+     * @param cycleResolved 输出：每个有环分量（下标与 graph.cycles() 对应）是否已通过放弃软约束完全排序，可为空
+     * @return 排序后的 Mod 列表
+     */
+    static QList<ModItem *> sortMods(const ModDependencyGraph &graph, const QStringList &typePriority,
+                                     QStringList *droppedHints = nullptr, QList<bool> *cycleResolved = nullptr);
+
     /**
      * @brief 检查是否存在循环依赖
      *
@@ -41,66 +66,52 @@ public:
      * @return 如果存在循环依赖返回 true
      */
     static bool hasCircularDependency(const QList<ModItem *> &mods);
+    static bool hasCircularDependency(const ModDependencyGraph &graph) { return graph.hasCycle(); }
 
     /**
      * @brief 获取循环依赖的详细信息
      *
      * @param mods Mod 列表
-     * @return 循环依赖的 Mod ID 列表
+     * @return 处于循环中的 Mod ID 列表（不包括只依赖循环的 Mod）
      */
     static QStringList getCircularDependencies(const QList<ModItem *> &mods);
-
-private:
-    /**
-     * @brief 拓扑排序（Kahn算法）
-     *
-     * @param mods Mod 列表
-     * @param graph 依赖图（key依赖value中的所有mod）
-     * @param inDegree 入度表
-     * @return 排序后的 Mod 列表
-     */
-    static QList<ModItem *> topologicalSort(const QList<ModItem *> &mods,
-                                            const QMap<QString, QStringList> &graph,
-                                            QMap<QString, int> inDegree);
+    static QStringList getCircularDependencies(const ModDependencyGraph &graph) { return graph.cyclicPackageIds(); }
 
     /**
-     * @brief 构建依赖关系图
+     * @brief 获取具体的循环路径
      *
-     * @param mods Mod 列表
-     * @param outGraph 输出：依赖图
-     * @param outInDegree 输出：入度表
+     * @param graph 依赖图
+     * @return 每个循环一项，每项为构成循环的约束描述（按循环顺序，打断其中任意一条即可）
      */
-    static void buildDependencyGraph(const QList<ModItem *> &mods,
-                                     QMap<QString, QStringList> &outGraph,
-                                     QMap<QString, int> &outInDegree);
+    static QList<QStringList> describeCycles(const ModDependencyGraph &graph);
 
     /**
-     * @brief 获取类型优先级
+     * @brief 描述一条约束边
      *
-     * @param type Mod 类型
-     * @param typePriority 类型优先级列表
-     * @return 优先级值（越小越优先，未设置的为最大值）
+     * @param graph 依赖图
+     * @param from 必须先加载的节点
+     * @param to 必须后加载的节点
+     * @param kind 约束类型
+     * @return 可读的约束描述，例如 "b 依赖 a (modDependencies)"
      */
-    static int getTypePriority(const QString &type, const QStringList &typePriority);
+    static QString describeEdge(const ModDependencyGraph &graph, int from, int to, ModEdgeKind kind);
 
+private:
     /**
-     * @brief 在满足依赖的前提下，按类型优先级稳定排序
+     * @brief 获取每个类型的优先级
      *
-     * @param mods 已经拓扑排序的 Mod 列表
      * @param typePriority 类型优先级列表
-     * @return 优化后的 Mod 列表
+     * @return 类型到优先级值的映射（越小越优先，未设置的类型不在映射中）
      */
-    static QList<ModItem *> stabilizeSortByTypePriority(const QList<ModItem *> &mods,
-                                                        const QStringList &typePriority);
+    static QHash<QString, int> buildTypeRanks(const QStringList &typePriority);
 
     /**
-     * @brief 检查能否安全交换两个相邻 Mod 的位置
+     * @brief 为有环分量选出需要放弃的软约束
      *
-     * @param mod1 前面的 Mod
-     * @param mod2 后面的 Mod
-     * @return 如果可以交换返回 true
+     * @param graph 依赖图
+     * @return 按边下标标记的放弃集合（无环时全部为 false）
      */
-    static bool canSwap(ModItem *mod1, ModItem *mod2);
+    static QList<bool> relaxSoftConstraints(const ModDependencyGraph &graph);
 };
 
 #endif // MODSORTER_H
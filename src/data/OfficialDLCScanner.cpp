@@ -1,8 +1,11 @@
 #include "OfficialDLCScanner.h"
+#include "AboutXmlParser.h"
+#include "ModCatalogCache.h"
+#include "ScanProgress.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentMap>
 
 OfficialDLCScanner::OfficialDLCScanner() {
 }
@@ -15,7 +18,7 @@ void OfficialDLCScanner::setDataPath(const QString &path) {
     m_dataPath = path;
 }
 
-bool OfficialDLCScanner::scanAllDLCs() {
+bool OfficialDLCScanner::scanAllDLCs(ScanProgress *progress) {
     clear();
 
     QDir dataDir(m_dataPath);
@@ -26,10 +29,45 @@ bool OfficialDLCScanner::scanAllDLCs() {
     // 获取所有DLC目录
     QStringList dlcDirs = dataDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
 
-    for (const QString &dlcDirName: dlcDirs) {
-        QString dlcDirPath = dataDir.absoluteFilePath(dlcDirName);
-        ModItem *dlc = scanDLCDirectory(dlcDirPath);
+    if (progress) {
+        progress->addFound(dlcDirs.size());
+    }
+
+    // QDir内部有惰性缓存，不在工作线程间共享，只共享根路径字符串
+    const QString rootPath = dataDir.absolutePath();
+    const std::atomic<bool> *cancelFlag = progress ? progress->getCancelFlag() : nullptr;
+    auto scanOne = [this, &rootPath, progress, cancelFlag](const QString &dlcDirName) -> ModItem * {
+        // 已取消时剩余目录直接跳过，不再访问磁盘
+        if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        ModItem *dlc = scanDLCDirectory(QDir(rootPath).absoluteFilePath(dlcDirName), cancelFlag);
+        if (progress) {
+            progress->markDone(dlc); // 解析完成后立即发布，不等待合并阶段
+        }
+        return dlc;
+    };
+
+    // 解析阶段：并行模式下结果仍按dlcDirs的顺序返回，保证与串行扫描一致
+    QList<ModItem *> parsedDLCs;
+    if (m_parallelScan) {
+        parsedDLCs = QtConcurrent::blockingMapped<QList<ModItem *>>(dlcDirs, scanOne);
+    } else {
+        parsedDLCs.reserve(dlcDirs.size());
+        for (const QString &dlcDirName: dlcDirs) {
+            parsedDLCs.append(scanOne(dlcDirName));
+        }
+    }
 
+    // 被取消时丢弃本次的全部结果，扫描器保持清空状态
+    if (progress && progress->isCancelled()) {
+        qDeleteAll(parsedDLCs);
+        return false;
+    }
+
+    // 合并阶段：在当前线程按固定顺序写入缓存和映射
+    for (ModItem *dlc: parsedDLCs) {
         if (dlc && dlc->isValid()) {
             dlc->packageId = dlc->packageId.toLower();
             m_scannedDLCs.append(dlc);
@@ -42,6 +80,66 @@ bool OfficialDLCScanner::scanAllDLCs() {
     return true;
 }
 
+ModDirectoryRescan OfficialDLCScanner::rescanDLCDirectory(const QString &dlcDirPath) {
+    ModDirectoryRescan result;
+
+    const QString cleanPath = QDir::cleanPath(dlcDirPath);
+    ModItem *existing = nullptr;
+    for (ModItem *dlc: m_scannedDLCs) {
+        if (QDir::cleanPath(dlc->sourcePath) == cleanPath) {
+            existing = dlc;
+            break;
+        }
+    }
+
+    ModItem *fresh = nullptr;
+    if (QDir(dlcDirPath).exists()) {
+        fresh = scanDLCDirectory(dlcDirPath);
+        if (fresh && !fresh->isValid()) {
+            delete fresh;
+            fresh = nullptr;
+        }
+    }
+
+    if (fresh) {
+        fresh->packageId = fresh->packageId.toLower();
+    }
+
+    if (existing && !fresh) {
+        // DLC目录被删除或About.xml失效
+        m_scannedDLCs.removeOne(existing);
+        if (m_packageIdMap.value(existing->packageId) == existing) {
+            m_packageIdMap.remove(existing->packageId);
+        }
+
+        result.change = ModDirectoryRescan::Removed;
+        result.mod = existing;
+        result.oldPackageId = existing->packageId;
+    } else if (existing && fresh) {
+        // 原地更新，保持ModItem指针不变
+        result.oldPackageId = existing->packageId;
+        if (m_packageIdMap.value(existing->packageId) == existing) {
+            m_packageIdMap.remove(existing->packageId);
+        }
+
+        *existing = std::move(*fresh);
+        delete fresh;
+
+        m_packageIdMap[existing->packageId] = existing;
+
+        result.change = ModDirectoryRescan::Updated;
+        result.mod = existing;
+    } else if (fresh) {
+        m_scannedDLCs.append(fresh);
+        m_packageIdMap[fresh->packageId] = fresh;
+
+        result.change = ModDirectoryRescan::Added;
+        result.mod = fresh;
+    }
+
+    return result;
+}
+
 ModItem *OfficialDLCScanner::findDLCByPackageId(const QString &packageId) const {
     return m_packageIdMap.value(packageId, nullptr);
 }
@@ -62,7 +160,7 @@ QString OfficialDLCScanner::getDefaultDataPath(const QString &gameInstallPath) {
     return QDir(gameInstallPath).absoluteFilePath("Data");
 }
 
-ModItem *OfficialDLCScanner::scanDLCDirectory(const QString &dlcDirPath) {
+ModItem *OfficialDLCScanner::scanDLCDirectory(const QString &dlcDirPath, const std::atomic<bool> *cancelFlag) {
     // 检查About.xml文件是否存在
     QString aboutXmlPath = QDir(dlcDirPath).absoluteFilePath("About/About.xml");
 
@@ -70,14 +168,28 @@ ModItem *OfficialDLCScanner::scanDLCDirectory(const QString &dlcDirPath) {
         return nullptr;
     }
 
-    ModItem *dlc = new ModItem();
+    ModItem *dlc = nullptr;
 
-    if (!parseAboutXml(dlc, aboutXmlPath)) {
-        delete dlc;
-        return nullptr;
+    if (m_catalogCache) {
+        // 优先从解析缓存读取，About.xml未变化时不重新解析
+        dlc = m_catalogCache->loadOrParse(dlcDirPath, aboutXmlPath,
+                                          [cancelFlag](ModItem *item, const QByteArray &data) {
+                                              return AboutXmlParser::parse(item, data, cancelFlag);
+                                          });
+        if (!dlc) {
+            return nullptr;
+        }
+    } else {
+        dlc = new ModItem();
+
+        if (!AboutXmlParser::parseFile(dlc, aboutXmlPath, cancelFlag)) {
+            delete dlc;
+            return nullptr;
+        }
     }
 
     dlc->sourcePath = dlcDirPath;
+    dlc->source = ModSource::Official;
 
     // 判断是否为Core（Ludeon.RimWorld），Core不应标记为官方DLC
     if (dlc->packageId.compare("Ludeon.RimWorld", Qt::CaseInsensitive) == 0) {
@@ -99,307 +211,3 @@ ModItem *OfficialDLCScanner::scanDLCDirectory(const QString &dlcDirPath) {
 
     return dlc;
 }
-
-bool OfficialDLCScanner::parseAboutXml(ModItem *dlc, const QString &aboutXmlPath) {
-    QFile file(aboutXmlPath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        return false;
-    }
-
-    QXmlStreamReader xml(&file);
-    int depth = 0; // 跟踪 XML 深度
-
-    while (!xml.atEnd() && !xml.hasError()) {
-        QXmlStreamReader::TokenType token = xml.readNext();
-
-        if (token == QXmlStreamReader::StartElement) {
-            depth++;
-            QString elementName = xml.name().toString();
-
-            // 只处理 ModMetaData 直接子元素（深度为2）
-            if (depth == 2) {
-                if (elementName == "name") {
-                    dlc->name = xml.readElementText();
-                    depth--;
-                } else if (elementName == "author" || elementName == "authors") {
-                    dlc->author = xml.readElementText();
-                    depth--;
-                } else if (elementName == "description") {
-                    dlc->description = xml.readElementText();
-                    depth--;
-                } else if (elementName == "packageId") {
-                    // 只在顶层读取 packageId
-                    QString packageId = xml.readElementText();
-                    dlc->packageId = packageId;
-                    dlc->identifier = packageId;
-                    depth--;
-                } else if (elementName == "steamAppId") {
-                    QString steamId = xml.readElementText();
-                    dlc->steamId = steamId;
-                    depth--;
-                } else if (elementName == "url") {
-                    dlc->url = xml.readElementText();
-                    depth--;
-                } else if (elementName == "supportedVersions") {
-                    parseSupportedVersions(xml, dlc);
-                    depth--;
-                } else if (elementName == "modDependencies") {
-                    parseModDependencies(xml, dlc);
-                    depth--;
-                } else if (elementName == "modDependenciesByVersion") {
-                    parseModDependenciesByVersion(xml, dlc);
-                    depth--;
-                } else if (elementName == "loadBefore") {
-                    parseLoadBefore(xml, dlc);
-                    depth--;
-                } else if (elementName == "loadAfter") {
-                    parseLoadAfter(xml, dlc);
-                    depth--;
-                } else if (elementName == "loadBeforeByVersion") {
-                    parseLoadBeforeByVersion(xml, dlc);
-                    depth--;
-                } else if (elementName == "loadAfterByVersion") {
-                    parseLoadAfterByVersion(xml, dlc);
-                    depth--;
-                } else if (elementName == "forceLoadBefore") {
-                    parseForceLoadBefore(xml, dlc);
-                    depth--;
-                } else if (elementName == "forceLoadAfter") {
-                    parseForceLoadAfter(xml, dlc);
-                    depth--;
-                } else if (elementName == "incompatibleWith") {
-                    parseIncompatibleWith(xml, dlc);
-                    depth--;
-                } else if (elementName == "incompatibleWithByVersion") {
-                    parseIncompatibleWithByVersion(xml, dlc);
-                    depth--;
-                }
-            }
-        } else if (token == QXmlStreamReader::EndElement) {
-            depth--;
-        }
-    }
-
-    file.close();
-
-    return !xml.hasError() && dlc->isValid();
-}
-
-void OfficialDLCScanner::parseSupportedVersions(QXmlStreamReader &xml, ModItem *mod) {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "supportedVersions")) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li") {
-            mod->addSupportedVersion(xml.readElementText());
-        }
-    }
-}
-
-void OfficialDLCScanner::parseModDependencies(QXmlStreamReader &xml, ModItem *mod) {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "modDependencies")) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li") {
-            QString depPackageId = parseDependencyItem(xml);
-            if (!depPackageId.isEmpty()) {
-                mod->addDependency(depPackageId);
-            }
-        }
-    }
-}
-
-void OfficialDLCScanner::parseModDependenciesByVersion(QXmlStreamReader &xml, ModItem *mod) {
-    QSet<QString> allDependencies;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "modDependenciesByVersion")) {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v")) {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag)) {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li") {
-                    QString depPackageId = parseDependencyItem(xml);
-                    if (!depPackageId.isEmpty()) {
-                        allDependencies.insert(depPackageId);
-                    }
-                }
-            }
-        }
-    }
-
-    for (const QString &dep: allDependencies) {
-        mod->addDependency(dep);
-    }
-}
-
-QString OfficialDLCScanner::parseDependencyItem(QXmlStreamReader &xml) {
-    QString packageId;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "li")) {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement) {
-            if (xml.name() == "packageId") {
-                packageId = xml.readElementText();
-                break;
-            }
-        } else if (xml.tokenType() == QXmlStreamReader::Characters) {
-            QString text = xml.text().toString().trimmed();
-            if (!text.isEmpty()) {
-                packageId = text;
-            }
-        }
-    }
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "li")) {
-        xml.readNext();
-    }
-
-    return packageId;
-}
-
-void OfficialDLCScanner::parseLoadBefore(QXmlStreamReader &xml, ModItem *mod) {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadBefore")) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li") {
-            mod->addLoadBefore(xml.readElementText());
-        }
-    }
-}
-
-void OfficialDLCScanner::parseLoadAfter(QXmlStreamReader &xml, ModItem *mod) {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadAfter")) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li") {
-            mod->addLoadAfter(xml.readElementText());
-        }
-    }
-}
-
-void OfficialDLCScanner::parseLoadBeforeByVersion(QXmlStreamReader &xml, ModItem *mod) {
-    QSet<QString> allLoadBefore;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadBeforeByVersion")) {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v")) {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag)) {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li") {
-                    allLoadBefore.insert(xml.readElementText());
-                }
-            }
-        }
-    }
-
-    for (const QString &item: allLoadBefore) {
-        mod->addLoadBefore(item);
-    }
-}
-
-void OfficialDLCScanner::parseLoadAfterByVersion(QXmlStreamReader &xml, ModItem *mod) {
-    QSet<QString> allLoadAfter;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadAfterByVersion")) {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v")) {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag)) {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li") {
-                    allLoadAfter.insert(xml.readElementText());
-                }
-            }
-        }
-    }
-
-    for (const QString &item: allLoadAfter) {
-        mod->addLoadAfter(item);
-    }
-}
-
-void OfficialDLCScanner::parseForceLoadBefore(QXmlStreamReader &xml, ModItem *mod) {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "forceLoadBefore")) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li") {
-            mod->addForceLoadBefore(xml.readElementText());
-        }
-    }
-}
-
-void OfficialDLCScanner::parseForceLoadAfter(QXmlStreamReader &xml, ModItem *mod) {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "forceLoadAfter")) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li") {
-            mod->addForceLoadAfter(xml.readElementText());
-        }
-    }
-}
-
-void OfficialDLCScanner::parseIncompatibleWith(QXmlStreamReader &xml, ModItem *mod) {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "incompatibleWith")) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li") {
-            mod->addIncompatibleWith(xml.readElementText());
-        }
-    }
-}
-
-void OfficialDLCScanner::parseIncompatibleWithByVersion(QXmlStreamReader &xml, ModItem *mod) {
-    QSet<QString> allIncompatible;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "incompatibleWithByVersion")) {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v")) {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag)) {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li") {
-                    allIncompatible.insert(xml.readElementText());
-                }
-            }
-        }
-    }
-
-    for (const QString &item: allIncompatible) {
-        mod->addIncompatibleWith(item);
-    }
-}
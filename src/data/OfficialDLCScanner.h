@@ -5,7 +5,7 @@
 #include <QList>
 #include <QMap>
 #include <QString>
-#include <QXmlStreamReader>
+#include <atomic>
 
 /**
  * @brief 官方DLC扫描器
@@ -14,6 +14,9 @@
  * 官方DLC路径: {游戏安装路径}/Data
  * 每个DLC目录包含: About\About.xml
  */
+class ModCatalogCache;
+class ScanProgress;
+
 class OfficialDLCScanner
 {
 public:
@@ -26,8 +29,19 @@ public:
 
     QString getDataPath() const { return m_dataPath; }
 
-    // 扫描所有官方DLC
-    bool scanAllDLCs();
+    // 设置是否并行扫描（默认开启，使用Qt Concurrent全局线程池解析各DLC目录）
+    void setParallelScan(bool enabled) { m_parallelScan = enabled; }
+
+    bool isParallelScan() const { return m_parallelScan; }
+
+    // 设置解析缓存（可为nullptr，缓存对象由调用者持有）
+    void setCatalogCache(ModCatalogCache *cache) { m_catalogCache = cache; }
+
+    // 扫描所有官方DLC（progress不为空时发布扫描进度；被取消时丢弃结果并返回false）
+    bool scanAllDLCs(ScanProgress *progress = nullptr);
+
+    // 增量重扫单个DLC目录，原地更新扫描结果
+    ModDirectoryRescan rescanDLCDirectory(const QString &dlcDirPath);
 
     // 获取扫描到的DLC列表
     QList<ModItem *> getScannedDLCs() const { return m_scannedDLCs; }
@@ -45,26 +59,11 @@ private:
     QString m_dataPath;                      // RimWorld Data路径
     QList<ModItem *> m_scannedDLCs;          // 扫描到的DLC列表
     QMap<QString, ModItem *> m_packageIdMap; // PackageId到DLC的映射
+    bool m_parallelScan = true;              // 是否并行解析About.xml
+    ModCatalogCache *m_catalogCache = nullptr; // 解析缓存（不持有）
 
     // 扫描单个DLC目录
-    ModItem *scanDLCDirectory(const QString &dlcDirPath);
-
-    // 解析About.xml文件
-    bool parseAboutXml(ModItem *dlc, const QString &aboutXmlPath);
-
-    // 辅助解析方法
-    void parseSupportedVersions(QXmlStreamReader &xml, ModItem *mod);
-    void parseModDependencies(QXmlStreamReader &xml, ModItem *mod);
-    void parseModDependenciesByVersion(QXmlStreamReader &xml, ModItem *mod);
-    QString parseDependencyItem(QXmlStreamReader &xml);
-    void parseLoadBefore(QXmlStreamReader &xml, ModItem *mod);
-    void parseLoadAfter(QXmlStreamReader &xml, ModItem *mod);
-    void parseLoadBeforeByVersion(QXmlStreamReader &xml, ModItem *mod);
-    void parseLoadAfterByVersion(QXmlStreamReader &xml, ModItem *mod);
-    void parseForceLoadBefore(QXmlStreamReader &xml, ModItem *mod);
-    void parseForceLoadAfter(QXmlStreamReader &xml, ModItem *mod);
-    void parseIncompatibleWith(QXmlStreamReader &xml, ModItem *mod);
-    void parseIncompatibleWithByVersion(QXmlStreamReader &xml, ModItem *mod);
+    ModItem *scanDLCDirectory(const QString &dlcDirPath, const std::atomic<bool> *cancelFlag = nullptr);
 };
 
 #endif // OFFICIALDLCSCANNER_H
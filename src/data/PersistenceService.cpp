@@ -0,0 +1,109 @@
+#include "PersistenceService.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+PersistenceService &PersistenceService::instance()
+{
+    static PersistenceService service;
+    return service;
+}
+
+PersistenceService::PersistenceService()
+{
+    // 写入以磁盘IO为主，两个线程足够让配置文件和用户数据互不阻塞
+    m_pool.setMaxThreadCount(2);
+}
+
+PersistenceService::~PersistenceService()
+{
+    flush();
+}
+
+QFuture<bool> PersistenceService::save(const QString &filePath, Writer writer, QIODevice::OpenMode mode)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // 已有尚未开始的请求时只替换快照，两次保存共享同一个结果
+    auto it = m_pending.find(filePath);
+    if (it != m_pending.end())
+    {
+        it->writer = std::move(writer);
+        it->mode = mode;
+        return it->promise->future();
+    }
+
+    Request request{std::move(writer), mode, std::make_shared<QPromise<bool>>()};
+    request.promise->start();
+    QFuture<bool> future = request.promise->future();
+    m_pending.insert(filePath, request);
+
+    if (!m_running.contains(filePath))
+    {
+        m_running.insert(filePath);
+        m_pool.start([this, filePath]()
+                     { drain(filePath); });
+    }
+    return future;
+}
+
+void PersistenceService::flush()
+{
+    m_pool.waitForDone();
+}
+
+void PersistenceService::drain(const QString &filePath)
+{
+    for (;;)
+    {
+        Request request;
+        {
+            QMutexLocker locker(&m_mutex);
+            auto it = m_pending.find(filePath);
+            if (it == m_pending.end())
+            {
+                m_running.remove(filePath);
+                return;
+            }
+            request = it.value();
+            m_pending.erase(it);
+        }
+
+        const bool success = writeAtomically(filePath, request);
+        request.promise->addResult(success);
+        request.promise->finish();
+    }
+}
+
+bool PersistenceService::writeAtomically(const QString &filePath, const Request &request)
+{
+    // 确保目录存在
+    QDir dir = QFileInfo(filePath).dir();
+    if (!dir.exists())
+    {
+        dir.mkpath(".");
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(request.mode))
+    {
+        qWarning() << "[PersistenceService] Cannot open" << filePath << ":" << file.errorString();
+        return false;
+    }
+
+    if (!request.writer(&file))
+    {
+        file.cancelWriting();
+        qWarning() << "[PersistenceService] Failed to serialize" << filePath;
+        return false;
+    }
+
+    if (!file.commit())
+    {
+        qWarning() << "[PersistenceService] Cannot commit" << filePath << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef PERSISTENCESERVICE_H
+#define PERSISTENCESERVICE_H
+
+#include <QFuture>
+#include <QHash>
+#include <QIODevice>
+#include <QMutex>
+#include <QPromise>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief 异步持久化服务（配置文件和用户数据共用）
+ *
+ * 调用方在GUI线程中复制一份数据快照，序列化和写入都在工作线程中完成：
+ * - 通过 QSaveFile 写入临时文件，成功后原子替换目标文件，写到一半崩溃不会留下截断的文件
+ * - 同一路径上尚未开始的请求会合并，连续多次保存只写入最新的快照，合并的请求共享同一个结果
+ * - 同一路径的写入按提交顺序串行执行
+ */
+class PersistenceService
+{
+public:
+    // 把快照序列化到device，失败时返回false
+    using Writer = std::function<bool(QIODevice *device)>;
+
+    static PersistenceService &instance();
+
+    // 提交保存请求，返回写入结果（true表示已原子替换目标文件）
+    QFuture<bool> save(const QString &filePath, Writer writer, QIODevice::OpenMode mode = QIODevice::WriteOnly);
+
+    // 等待所有已提交的请求写入完成
+    void flush();
+
+private:
+    PersistenceService();
+    ~PersistenceService();
+
+    struct Request
+    {
+        Writer writer;
+        QIODevice::OpenMode mode;
+        std::shared_ptr<QPromise<bool>> promise;
+    };
+
+    // 在工作线程中依次写入该路径上的请求，直到没有新的请求
+    void drain(const QString &filePath);
+
+    // 通过 QSaveFile 写入并提交
+    static bool writeAtomically(const QString &filePath, const Request &request);
+
+    QMutex m_mutex;
+    QHash<QString, Request> m_pending; // 尚未开始写入的请求（每个路径最多一个）
+    QSet<QString> m_running;           // 正在写入的路径
+    QThreadPool m_pool;
+
+    Q_DISABLE_COPY(PersistenceService)
+};
+
+#endif // PERSISTENCESERVICE_H
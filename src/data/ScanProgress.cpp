@@ -0,0 +1,41 @@
+#include "ScanProgress.h"
+#include <QMutexLocker>
+#include <utility>
+
+void ScanProgress::reset()
+{
+    m_foundCount.storeRelaxed(0);
+    m_doneCount.storeRelaxed(0);
+    m_cancelRequested.store(false, std::memory_order_relaxed);
+    m_cancelled.store(false, std::memory_order_relaxed);
+
+    QMutexLocker locker(&m_pendingMutex);
+    m_pending.clear();
+}
+
+void ScanProgress::addFound(int count)
+{
+    m_foundCount.fetchAndAddRelaxed(count);
+}
+
+void ScanProgress::markDone(const ModItem *mod)
+{
+    if (mod && mod->isValid())
+    {
+        // 在锁外复制，临界区内只做一次追加
+        ModItem snapshot = *mod;
+        snapshot.packageId = snapshot.packageId.toLower();
+
+        QMutexLocker locker(&m_pendingMutex);
+        m_pending.append(std::move(snapshot));
+    }
+
+    // 快照入队后再计数，界面看到的完成数不会超过已入队的数量
+    m_doneCount.fetchAndAddRelease(1);
+}
+
+QList<ModItem> ScanProgress::takePending()
+{
+    QMutexLocker locker(&m_pendingMutex);
+    return std::exchange(m_pending, QList<ModItem>());
+}
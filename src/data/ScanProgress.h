@@ -0,0 +1,63 @@
+#ifndef SCANPROGRESS_H
+#define SCANPROGRESS_H
+
+#include "ModItem.h"
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+
+/**
+ * @brief 扫描进度（扫描线程写入，界面线程轮询）
+ *
+ * - 计数器为原子变量，工作线程更新和界面读取都不加锁
+ * - 解析完成的Mod以快照形式进入待取队列，界面按固定频率批量取走，
+ *   快照与扫描器持有的ModItem无关，扫描结束前后都可以安全使用
+ * - 同时作为取消令牌：界面调用requestCancel()，扫描器在目录之间和解析过程中检查
+ */
+class ScanProgress
+{
+public:
+    ScanProgress() = default;
+
+    // 重置计数器、待取队列和取消标志（开始新的扫描前调用）
+    void reset();
+
+    // 发现了count个待扫描目录
+    void addFound(int count);
+
+    // 一个目录扫描完成；mod有效时把快照放入待取队列
+    void markDone(const ModItem *mod);
+
+    int getFoundCount() const { return m_foundCount.loadRelaxed(); }
+    int getDoneCount() const { return m_doneCount.loadRelaxed(); }
+
+    // 取走目前为止解析完成的Mod快照
+    QList<ModItem> takePending();
+
+    // 请求取消扫描（任意线程调用）
+    void requestCancel() { m_cancelRequested.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return m_cancelRequested.load(std::memory_order_relaxed); }
+
+    // 取消标志（传给AboutXmlParser，在解析过程中检查）
+    const std::atomic<bool> *getCancelFlag() const { return &m_cancelRequested; }
+
+    // 扫描器确认取消并丢弃结果时调用；取消请求晚于最后一次检查时扫描照常完成，不会调用
+    void markCancelled() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    // 扫描是否真的被取消（结果已丢弃），扫描结束后据此判断，而不是看是否请求过取消
+    bool wasCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+private:
+    QAtomicInt m_foundCount;
+    QAtomicInt m_doneCount;
+    std::atomic<bool> m_cancelRequested{false};
+    std::atomic<bool> m_cancelled{false};
+
+    QMutex m_pendingMutex;
+    QList<ModItem> m_pending;
+
+    Q_DISABLE_COPY(ScanProgress)
+};
+
+#endif // SCANPROGRESS_H
@@ -1,4 +1,8 @@
 #include "UserDataManager.h"
+#include "MappedFile.h"
+#include "PersistenceService.h"
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
@@ -6,11 +10,170 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QPromise>
+#include <functional>
 
 // 定义文件名常量
-const QString UserDataManager::MOD_DATA_FILE = "mod_data.json";
-const QString UserDataManager::TYPES_FILE = "types.json";
-const QString UserDataManager::TYPE_PRIORITY_FILE = "type_priority.json";
+const QString UserDataManager::MOD_DATA_FILE = "mod_data.cbor";
+const QString UserDataManager::TYPES_FILE = "types.cbor";
+const QString UserDataManager::TYPE_PRIORITY_FILE = "type_priority.cbor";
+const QString UserDataManager::MOD_DATA_JOURNAL_FILE = "mod_data.journal";
+const QString UserDataManager::LEGACY_MOD_DATA_FILE = "mod_data.json";
+const QString UserDataManager::LEGACY_TYPES_FILE = "types.json";
+const QString UserDataManager::LEGACY_TYPE_PRIORITY_FILE = "type_priority.json";
+
+namespace
+{
+    // 读取一个文本串（可能分块编码），读取后reader指向下一个值
+    bool readCborString(QCborStreamReader &reader, QString &out)
+    {
+        if (!reader.isString())
+        {
+            return false;
+        }
+
+        out.clear();
+        auto chunk = reader.readString();
+        while (chunk.status == QCborStreamReader::Ok)
+        {
+            out += chunk.data;
+            chunk = reader.readString();
+        }
+        return chunk.status == QCborStreamReader::EndOfString;
+    }
+
+    // 读取 文本串 -> 文本串 的映射；保存时按键排序写入，使用末尾提示插入即为均摊O(1)
+    bool readCborStringMap(QCborStreamReader &reader, QMap<QString, QString> &out)
+    {
+        if (!reader.isMap() || !reader.enterContainer())
+        {
+            return false;
+        }
+
+        QString key;
+        QString value;
+        while (reader.lastError() == QCborError::NoError && reader.hasNext())
+        {
+            if (!readCborString(reader, key))
+            {
+                return false;
+            }
+            if (reader.isString())
+            {
+                if (!readCborString(reader, value))
+                {
+                    return false;
+                }
+                out.insert(out.cend(), key, value);
+            }
+            else
+            {
+                reader.next(); // 跳过类型不符的值
+            }
+        }
+        return reader.leaveContainer();
+    }
+
+    // 读取文本串数组（忽略空串和其他类型的元素）
+    bool readCborStringList(QCborStreamReader &reader, QStringList &out)
+    {
+        if (!reader.isArray() || !reader.enterContainer())
+        {
+            return false;
+        }
+
+        QString value;
+        while (reader.lastError() == QCborError::NoError && reader.hasNext())
+        {
+            if (!reader.isString())
+            {
+                reader.next();
+                continue;
+            }
+            if (!readCborString(reader, value))
+            {
+                return false;
+            }
+            if (!value.isEmpty())
+            {
+                out.append(value);
+            }
+        }
+        return reader.leaveContainer();
+    }
+
+    // 映射文件，逐个处理顶层映射中的字段（不构建QCborValue树）。
+    // readField需要消费该字段的值（不认识的字段调用reader.next()跳过），返回false表示数据损坏
+    bool readCborFile(const QString &filePath,
+                      const std::function<bool(const QString &key, QCborStreamReader &reader)> &readField)
+    {
+        MappedFile file(filePath);
+        if (!file.open())
+        {
+            qWarning() << "无法打开用户数据文件:" << filePath;
+            return false;
+        }
+
+        QCborStreamReader reader(file.data());
+        if (!reader.isMap() || !reader.enterContainer())
+        {
+            qWarning() << "用户数据文件格式错误:" << filePath;
+            return false;
+        }
+
+        QString key;
+        while (reader.lastError() == QCborError::NoError && reader.hasNext())
+        {
+            if (!readCborString(reader, key) || !readField(key, reader))
+            {
+                qWarning() << "用户数据文件格式错误:" << filePath << reader.lastError().toString();
+                return false;
+            }
+        }
+        return reader.leaveContainer() && reader.lastError() == QCborError::NoError;
+    }
+
+    void writeCborStringMap(QCborStreamWriter &writer, const QMap<QString, QString> &map)
+    {
+        writer.startMap(map.size());
+        for (auto it = map.cbegin(); it != map.cend(); ++it)
+        {
+            writer.append(it.key());
+            writer.append(it.value());
+        }
+        writer.endMap();
+    }
+
+    void writeCborStringList(QCborStreamWriter &writer, const QStringList &list)
+    {
+        writer.startArray(list.size());
+        for (const QString &value : list)
+        {
+            writer.append(value);
+        }
+        writer.endArray();
+    }
+
+    // 读取旧版JSON文件（只在迁移时使用）
+    bool readLegacyJson(const QString &filePath, QJsonObject &root)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            qWarning() << "无法打开旧版用户数据文件:" << filePath;
+            return false;
+        }
+
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        if (!doc.isObject())
+        {
+            qWarning() << "旧版用户数据文件格式错误:" << filePath;
+            return false;
+        }
+        root = doc.object();
+        return true;
+    }
+}
 
 UserDataManager::UserDataManager()
 {
@@ -27,15 +190,26 @@ QString UserDataManager::getModType(const QString &packageId) const
 
 void UserDataManager::setModType(const QString &packageId, const QString &type)
 {
-    if (!packageId.isEmpty())
+    if (packageId.isEmpty())
     {
-        m_modTypes[packageId] = type;
+        return;
     }
+
+    auto it = m_modTypes.find(packageId);
+    if (it != m_modTypes.end() && it.value() == type)
+    {
+        return; // 未变化，不写日志
+    }
+    m_modTypes[packageId] = type;
+    appendJournal("type", packageId, type, false);
 }
 
 void UserDataManager::removeModType(const QString &packageId)
 {
-    m_modTypes.remove(packageId);
+    if (m_modTypes.remove(packageId) > 0)
+    {
+        appendJournal("type", packageId, QString(), true);
+    }
 }
 
 QString UserDataManager::getModRemark(const QString &packageId) const
@@ -45,15 +219,57 @@ QString UserDataManager::getModRemark(const QString &packageId) const
 
 void UserDataManager::setModRemark(const QString &packageId, const QString &remark)
 {
-    if (!packageId.isEmpty())
+    if (packageId.isEmpty())
     {
-        m_modRemarks[packageId] = remark;
+        return;
     }
+
+    auto it = m_modRemarks.find(packageId);
+    if (it != m_modRemarks.end() && it.value() == remark)
+    {
+        return; // 未变化，不写日志
+    }
+    m_modRemarks[packageId] = remark;
+    appendJournal("remark", packageId, remark, false);
 }
 
 void UserDataManager::removeModRemark(const QString &packageId)
 {
-    m_modRemarks.remove(packageId);
+    if (m_modRemarks.remove(packageId) > 0)
+    {
+        appendJournal("remark", packageId, QString(), true);
+    }
+}
+
+bool UserDataManager::updateModUserData(const QString &packageId, const QString &type, const QString &remark)
+{
+    if (packageId.isEmpty())
+    {
+        return false;
+    }
+
+    const bool changed = (type.isEmpty() ? m_modTypes.contains(packageId) : m_modTypes.value(packageId) != type) ||
+                         (remark.isEmpty() ? m_modRemarks.contains(packageId) : m_modRemarks.value(packageId) != remark);
+
+    // 空值表示清除，与保存快照时的约定一致
+    if (type.isEmpty())
+    {
+        removeModType(packageId);
+    }
+    else
+    {
+        setModType(packageId, type);
+    }
+
+    if (remark.isEmpty())
+    {
+        removeModRemark(packageId);
+    }
+    else
+    {
+        setModRemark(packageId, remark);
+    }
+    return changed;
 }
 
 QStringList UserDataManager::getAllTypes() const
@@ -91,53 +307,100 @@ bool UserDataManager::hasType(const QString &type) const
 
 bool UserDataManager::loadModData()
 {
-    QString filePath = QDir(getModDataPath()).absoluteFilePath(MOD_DATA_FILE);
-    QFile file(filePath);
+    const QDir dir(getModDataPath());
+    const QString filePath = dir.absoluteFilePath(MOD_DATA_FILE);
+    const QString legacyPath = dir.absoluteFilePath(LEGACY_MOD_DATA_FILE);
 
-    if (!file.exists())
+    // 等待正在进行的压缩：否则可能读到旧快照，而轮转日志恰好在重放前被删除
+    m_compaction.waitForFinished();
+
+    const bool hasSnapshot = QFile::exists(filePath);
+    const bool hasLegacy = QFile::exists(legacyPath);
+
+    // 日志基于快照，重新加载前先关闭当前日志
+    m_journal.close();
+    m_journalRecords = 0;
+    m_snapshotLoaded = false;
+    m_modTypes.clear();
+    m_modRemarks.clear();
+
+    bool loaded = false;
+    bool needsSnapshot = false;
+    if (hasSnapshot)
     {
-        qDebug() << "Mod数据文件不存在，使用空数据";
-        return true; // 文件不存在不算错误
+        auto readField = [this](const QString &key, QCborStreamReader &reader)
+        {
+            if (key == "types")
+            {
+                return readCborStringMap(reader, m_modTypes);
+            }
+            if (key == "remarks")
+            {
+                return readCborStringMap(reader, m_modRemarks);
+            }
+            return reader.next();
+        };
+
+        loaded = readCborFile(filePath, readField);
+        if (!loaded)
+        {
+            // 保留损坏的快照以便手动恢复，之后写入的新快照会覆盖原文件
+            m_modTypes.clear();
+            m_modRemarks.clear();
+            QFile::remove(filePath + ".bad");
+            QFile::copy(filePath, filePath + ".bad");
+            qWarning() << "Mod数据快照损坏，已备份为:" << filePath + ".bad";
+        }
     }
 
-    if (!file.open(QIODevice::ReadOnly))
+    if (!loaded && hasLegacy)
     {
-        qWarning() << "无法打开Mod数据文件:" << filePath;
-        return false;
-    }
+        // 从旧版JSON迁移（或在快照损坏时回退），加载后写入CBOR快照（旧文件保留不动）
+        QJsonObject root;
+        if (readLegacyJson(legacyPath, root))
+        {
+            const QJsonObject types = root["types"].toObject();
+            for (auto it = types.begin(); it != types.end(); ++it)
+            {
+                m_modTypes[it.key()] = it.value().toString();
+            }
 
-    QByteArray data = file.readAll();
-    file.close();
+            const QJsonObject remarks = root["remarks"].toObject();
+            for (auto it = remarks.begin(); it != remarks.end(); ++it)
+            {
+                m_modRemarks[it.key()] = it.value().toString();
+            }
+            qDebug() << "读取旧版Mod数据文件:" << legacyPath;
+            loaded = true;
+            needsSnapshot = true;
+        }
+    }
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject())
+    if (!hasSnapshot && !hasLegacy)
     {
-        qWarning() << "Mod数据文件格式错误";
-        return false;
+        qDebug() << "Mod数据文件不存在，使用空数据"; // 文件不存在不算错误，但仍可能有尚未压缩的日志
+        loaded = true;
     }
 
-    QJsonObject root = doc.object();
+    // 无论快照能否读取都重放日志：先是压缩中断时留下的轮转日志，再是当前日志
+    const int replayed = replayJournal(rotatedJournalPath());
+    m_journalRecords = replayJournal(journalPath());
+    if (replayed + m_journalRecords > 0)
+    {
+        qDebug() << "重放Mod数据日志:" << replayed + m_journalRecords << "条记录";
+    }
 
-    // 加载类型映射
-    m_modTypes.clear();
-    if (root.contains("types") && root["types"].isObject())
+    if (!loaded)
     {
-        QJsonObject types = root["types"].toObject();
-        for (auto it = types.begin(); it != types.end(); ++it)
-        {
-            m_modTypes[it.key()] = it.value().toString();
-        }
+        // 没有可用的快照时，压缩会用不完整的数据覆盖快照并删除日志，因此只追加日志
+        qWarning() << "无法加载Mod数据快照，修改只写入日志，暂停压缩";
+        return false;
     }
 
-    // 加载备注映射
-    m_modRemarks.clear();
-    if (root.contains("remarks") && root["remarks"].isObject())
+    m_snapshotLoaded = true;
+    if (needsSnapshot)
     {
-        QJsonObject remarks = root["remarks"].toObject();
-        for (auto it = remarks.begin(); it != remarks.end(); ++it)
-        {
-            m_modRemarks[it.key()] = it.value().toString();
-        }
+        saveModDataAsync();
     }
 
     qDebug() << "成功加载Mod数据:" << m_modTypes.size() << "个类型," << m_modRemarks.size() << "个备注";
@@ -145,80 +408,214 @@ bool UserDataManager::loadModData()
 }
 
 bool UserDataManager::saveModData()
+{
+    return saveModDataAsync().result();
+}
+
+QFuture<bool> UserDataManager::saveModDataAsync()
 {
     QString filePath = QDir(getModDataPath()).absoluteFilePath(MOD_DATA_FILE);
-    QFile file(filePath);
 
-    if (!file.open(QIODevice::WriteOnly))
+    // 快照未成功加载时内存中的数据不完整，不能覆盖快照，也不能轮转或删除日志
+    if (!m_snapshotLoaded)
     {
-        qWarning() << "无法创建Mod数据文件:" << filePath;
-        return false;
+        qWarning() << "Mod数据快照未加载，跳过保存:" << filePath;
+        QPromise<bool> skipped;
+        skipped.start();
+        skipped.addResult(false);
+        skipped.finish();
+        return skipped.future();
     }
 
-    QJsonObject root;
+    // 复制快照（隐式共享，不复制数据），序列化在工作线程中进行
+    const QMap<QString, QString> modTypes = m_modTypes;
+    const QMap<QString, QString> modRemarks = m_modRemarks;
 
-    // 保存类型映射
-    QJsonObject types;
-    for (auto it = m_modTypes.begin(); it != m_modTypes.end(); ++it)
+    auto writer = [filePath, modTypes, modRemarks](QIODevice *device)
     {
-        types[it.key()] = it.value();
-    }
-    root["types"] = types;
+        // 直接流式写入设备，不构建中间树；写入错误由 QSaveFile::commit 报告
+        QCborStreamWriter cbor(device);
+        cbor.startMap(2);
+        cbor.append(QLatin1String("types"));
+        writeCborStringMap(cbor, modTypes);
+        cbor.append(QLatin1String("remarks"));
+        writeCborStringMap(cbor, modRemarks);
+        cbor.endMap();
 
-    // 保存备注映射
-    QJsonObject remarks;
-    for (auto it = m_modRemarks.begin(); it != m_modRemarks.end(); ++it)
+        qDebug() << "成功保存Mod数据到:" << filePath;
+        return true;
+    };
+
+    // 轮转日志：快照包含之前的全部修改，写入成功后即可删除轮转的日志。
+    // 上一次压缩尚未结束时不轮转，日志保留到下一次压缩（重放已包含在快照中的记录是幂等的）
+    const QString rotatedPath = rotatedJournalPath();
+    bool rotated = false;
+    if (m_compaction.isFinished())
     {
-        remarks[it.key()] = it.value();
+        m_journal.close();
+        const QString currentPath = journalPath();
+        if (QFile::exists(currentPath))
+        {
+            if (!QFile::exists(rotatedPath))
+            {
+                QFile::rename(currentPath, rotatedPath);
+            }
+            else
+            {
+                // 上一次压缩失败留下的轮转日志：把当前日志接在后面
+                QFile current(currentPath);
+                QFile target(rotatedPath);
+                if (current.open(QIODevice::ReadOnly) && target.open(QIODevice::WriteOnly | QIODevice::Append) &&
+                    target.write(current.readAll()) >= 0)
+                {
+                    current.close();
+                    QFile::remove(currentPath);
+                }
+            }
+        }
+        m_journalRecords = 0;
+        rotated = QFile::exists(rotatedPath);
     }
-    root["remarks"] = remarks;
 
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    QFuture<bool> written = PersistenceService::instance().save(filePath, writer);
+    if (!rotated)
+    {
+        return written;
+    }
 
-    qDebug() << "成功保存Mod数据到:" << filePath;
-    return true;
+    auto removeRotated = [rotatedPath](bool success)
+    {
+        if (success)
+        {
+            QFile::remove(rotatedPath);
+        }
+        return success;
+    };
+    m_compaction = written.then(removeRotated);
+    return m_compaction;
 }
 
-bool UserDataManager::loadTypes()
+bool UserDataManager::appendJournal(const QString &field, const QString &packageId, const QString &value, bool removed)
 {
-    QString filePath = QDir(getModDataPath()).absoluteFilePath(TYPES_FILE);
-    QFile file(filePath);
-
-    if (!file.exists())
+    if (!m_journal.isOpen())
     {
-        qDebug() << "Mod类型文件不存在，使用默认类型（核心、DLC）";
-        // 首次加载，添加默认的两个类型
-        m_types.clear();
-        m_types.append("核心");
-        m_types.append("DLC");
-        return true;
+        QDir().mkpath(getModDataPath());
+        m_journal.setFileName(journalPath());
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append))
+        {
+            qWarning() << "无法打开Mod数据日志:" << m_journal.fileName() << m_journal.errorString();
+            return false;
+        }
     }
 
-    if (!file.open(QIODevice::ReadOnly))
+    QJsonObject record;
+    record["field"] = field;
+    record["id"] = packageId;
+    record["value"] = removed ? QJsonValue(QJsonValue::Null) : QJsonValue(value);
+
+    // 每条记录一行，换行符在JSON字符串中会被转义
+    QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    if (m_journal.write(line) != line.size() || !m_journal.flush())
     {
-        qWarning() << "无法打开Mod类型文件:" << filePath;
+        qWarning() << "写入Mod数据日志失败:" << m_journal.errorString();
         return false;
     }
 
-    QByteArray data = file.readAll();
-    file.close();
+    if (++m_journalRecords >= JOURNAL_COMPACT_THRESHOLD && m_snapshotLoaded)
+    {
+        saveModDataAsync();
+    }
+    return true;
+}
+
+int UserDataManager::replayJournal(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return 0;
+    }
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject())
+    int count = 0;
+    while (!file.atEnd())
     {
-        qWarning() << "Mod类型文件格式错误";
-        return false;
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+        {
+            continue;
+        }
+
+        // 崩溃时最后一行可能只写了一半，跳过无法解析的记录
+        const QJsonDocument doc = QJsonDocument::fromJson(line);
+        const QJsonObject record = doc.object();
+        const QString packageId = record["id"].toString();
+        if (!doc.isObject() || packageId.isEmpty())
+        {
+            qWarning() << "跳过无效的Mod数据日志记录:" << filePath;
+            continue;
+        }
+
+        const QString field = record["field"].toString();
+        QMap<QString, QString> *target = field == "type" ? &m_modTypes : field == "remark" ? &m_modRemarks : nullptr;
+        if (!target)
+        {
+            continue;
+        }
+
+        if (record["value"].isNull())
+        {
+            target->remove(packageId);
+        }
+        else
+        {
+            target->insert(packageId, record["value"].toString());
+        }
+        ++count;
     }
+    return count;
+}
+
+QString UserDataManager::journalPath()
+{
+    return QDir(getModDataPath()).absoluteFilePath(MOD_DATA_JOURNAL_FILE);
+}
+
+QString UserDataManager::rotatedJournalPath()
+{
+    return journalPath() + ".1";
+}
+
+bool UserDataManager::loadTypes()
+{
+    const QDir dir(getModDataPath());
+    const QString filePath = dir.absoluteFilePath(TYPES_FILE);
+    const QString legacyPath = dir.absoluteFilePath(LEGACY_TYPES_FILE);
 
-    QJsonObject root = doc.object();
     m_types.clear();
+    if (QFile::exists(filePath))
+    {
+        auto readField = [this](const QString &key, QCborStreamReader &reader)
+        {
+            return key == "types" ? readCborStringList(reader, m_types) : reader.next();
+        };
 
-    if (root.contains("types") && root["types"].isArray())
+        if (!readCborFile(filePath, readField))
+        {
+            m_types.clear();
+            return false;
+        }
+    }
+    else if (QFile::exists(legacyPath))
     {
-        QJsonArray types = root["types"].toArray();
-        for (const QJsonValue &value : types)
+        // 从旧版JSON迁移
+        QJsonObject root;
+        if (!readLegacyJson(legacyPath, root))
+        {
+            return false;
+        }
+
+        for (const QJsonValue &value : root["types"].toArray())
         {
             QString type = value.toString();
             if (!type.isEmpty())
@@ -226,6 +623,16 @@ bool UserDataManager::loadTypes()
                 m_types.append(type);
             }
         }
+        qDebug() << "迁移旧版Mod类型文件:" << legacyPath;
+        saveTypes();
+    }
+    else
+    {
+        qDebug() << "Mod类型文件不存在，使用默认类型（核心、DLC）";
+        // 首次加载，添加默认的两个类型
+        m_types.append("核心");
+        m_types.append("DLC");
+        return true;
     }
 
     qDebug() << "成功加载" << m_types.size() << "个Mod类型";
@@ -235,28 +642,24 @@ bool UserDataManager::loadTypes()
 bool UserDataManager::saveTypes()
 {
     QString filePath = QDir(getModDataPath()).absoluteFilePath(TYPES_FILE);
-    QFile file(filePath);
 
-    if (!file.open(QIODevice::WriteOnly))
+    const QStringList types = m_types;
+    auto writer = [types](QIODevice *device)
     {
-        qWarning() << "无法创建Mod类型文件:" << filePath;
-        return false;
-    }
-
-    QJsonObject root;
-    QJsonArray types;
+        QCborStreamWriter cbor(device);
+        cbor.startMap(1);
+        cbor.append(QLatin1String("types"));
+        writeCborStringList(cbor, types);
+        cbor.endMap();
+        return true;
+    };
 
-    for (const QString &type : m_types)
+    if (!PersistenceService::instance().save(filePath, writer).result())
     {
-        types.append(type);
+        qWarning() << "无法保存Mod类型文件:" << filePath;
+        return false;
     }
 
-    root["types"] = types;
-
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
-
     qDebug() << "成功保存Mod类型到:" << filePath;
     return true;
 }
@@ -275,39 +678,44 @@ void UserDataManager::setTypePriority(const QStringList &priority)
 
 bool UserDataManager::loadTypePriority()
 {
-    QString filePath = QDir(getModDataPath()).absoluteFilePath(TYPE_PRIORITY_FILE);
+    const QDir dir(getModDataPath());
+    const QString filePath = dir.absoluteFilePath(TYPE_PRIORITY_FILE);
+    const QString legacyPath = dir.absoluteFilePath(LEGACY_TYPE_PRIORITY_FILE);
 
-    QFile file(filePath);
-    if (!file.exists())
+    m_typePriority.clear();
+    if (QFile::exists(filePath))
     {
-        qDebug() << "类型优先级文件不存在，使用默认顺序";
-        m_typePriority.clear();
-        return true;
-    }
+        auto readField = [this](const QString &key, QCborStreamReader &reader)
+        {
+            return key == "priority" ? readCborStringList(reader, m_typePriority) : reader.next();
+        };
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        qWarning() << "无法打开类型优先级文件:" << filePath;
-        return false;
+        if (!readCborFile(filePath, readField))
+        {
+            m_typePriority.clear();
+            return false;
+        }
     }
-
-    QByteArray data = file.readAll();
-    file.close();
-
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isObject())
+    else if (QFile::exists(legacyPath))
     {
-        qWarning() << "类型优先级文件格式错误";
-        return false;
-    }
-
-    QJsonObject root = doc.object();
-    QJsonArray priorityArray = root.value("priority").toArray();
+        // 从旧版JSON迁移
+        QJsonObject root;
+        if (!readLegacyJson(legacyPath, root))
+        {
+            return false;
+        }
 
-    m_typePriority.clear();
-    for (const QJsonValue &value : priorityArray)
+        for (const QJsonValue &value : root.value("priority").toArray())
+        {
+            m_typePriority.append(value.toString());
+        }
+        qDebug() << "迁移旧版类型优先级文件:" << legacyPath;
+        saveTypePriority();
+    }
+    else
     {
-        m_typePriority.append(value.toString());
+        qDebug() << "类型优先级文件不存在，使用默认顺序";
+        return true;
     }
 
     qDebug() << "成功加载类型优先级:" << m_typePriority.size() << "个类型";
@@ -318,27 +726,23 @@ bool UserDataManager::saveTypePriority()
 {
     QString filePath = QDir(getModDataPath()).absoluteFilePath(TYPE_PRIORITY_FILE);
 
-    QJsonObject root;
-    QJsonArray priorityArray;
-
-    for (const QString &type : m_typePriority)
+    const QStringList priority = m_typePriority;
+    auto writer = [priority](QIODevice *device)
     {
-        priorityArray.append(type);
-    }
-
-    root["priority"] = priorityArray;
+        QCborStreamWriter cbor(device);
+        cbor.startMap(1);
+        cbor.append(QLatin1String("priority"));
+        writeCborStringList(cbor, priority);
+        cbor.endMap();
+        return true;
+    };
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    if (!PersistenceService::instance().save(filePath, writer).result())
     {
         qWarning() << "无法写入类型优先级文件:" << filePath;
         return false;
     }
 
-    QJsonDocument doc(root);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
-
     qDebug() << "成功保存类型优先级到:" << filePath;
     return true;
 }
@@ -369,22 +773,6 @@ bool UserDataManager::saveModListToPath(const QString &filePath,
                                         const QString &version,
                                         const QMap<QString, QString> &otherData)
 {
-    QFile file(filePath);
-
-    // 确保目录存在
-    QFileInfo fileInfo(filePath);
-    QDir dir = fileInfo.dir();
-    if (!dir.exists())
-    {
-        dir.mkpath(".");
-    }
-
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        qWarning() << "无法创建Mod列表文件:" << filePath;
-        return false;
-    }
-
     // 写入XML
     QString xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
     xml += "<ModsConfigData>\n";
@@ -419,8 +807,18 @@ bool UserDataManager::saveModListToPath(const QString &filePath,
 
     xml += "</ModsConfigData>\n";
 
-    file.write(xml.toUtf8());
-    file.close();
+    // 通过临时文件写入后原子替换，目录由 PersistenceService 创建
+    const QByteArray data = xml.toUtf8();
+    const bool success = PersistenceService::instance()
+                             .save(filePath, [data](QIODevice *device)
+                                   { return device->write(data) == data.size(); },
+                                   QIODevice::WriteOnly | QIODevice::Text)
+                             .result();
+    if (!success)
+    {
+        qWarning() << "无法创建Mod列表文件:" << filePath;
+        return false;
+    }
 
     qDebug() << "成功保存Mod列表到:" << filePath;
     return true;
@@ -1,6 +1,8 @@
 #ifndef USERDATAMANAGER_H
 #define USERDATAMANAGER_H
 
+#include <QFile>
+#include <QFuture>
 #include <QMap>
 #include <QString>
 #include <QStringList>
@@ -12,7 +14,10 @@
  * 1. Mod类型和备注的映射
  * 2. 保存的Mod加载列表
  *
- * 数据存储在程序同目录下的UserData文件夹中
+ * 数据存储在程序同目录下的UserData文件夹中，快照为CBOR格式，加载时映射文件并流式解析；
+ * 只有旧版JSON文件时自动读取并迁移为CBOR。
+ * 类型和备注的每次修改都会以一行紧凑JSON追加到日志文件（mod_data.journal），
+ * 日志达到一定条数后在后台压缩为快照（mod_data.cbor），加载时先读快照再按顺序重放日志。
  */
 class UserDataManager
 {
@@ -39,6 +44,9 @@ public:
     // 移除Mod的备注
     void removeModRemark(const QString &packageId);
 
+    // 更新单个Mod的类型和备注（空值表示移除），只把变化追加到日志，返回是否有变化
+    bool updateModUserData(const QString &packageId, const QString &type, const QString &remark);
+
     // 获取所有Mod类型
     QStringList getAllTypes() const;
 
@@ -70,9 +78,14 @@ public:
     // 加载Mod数据（类型和备注）
     bool loadModData();
 
-    // 保存Mod数据（类型和备注）
+    // 保存Mod数据（类型和备注），等待写入完成
     bool saveModData();
 
+    // 异步保存Mod数据：立即复制快照，在工作线程中序列化并原子写入（连续调用会合并）
+    // 快照写入成功后删除已被快照包含的日志
+    // 快照未成功加载时不写入，返回false
+    QFuture<bool> saveModDataAsync();
+
     // 加载Mod类型列表
     bool loadTypes();
 
@@ -115,15 +128,39 @@ public:
     static bool initializeDirectories();
 
 private:
+    // 追加一条日志记录（removed为true表示移除），达到阈值时触发后台压缩
+    bool appendJournal(const QString &field, const QString &packageId, const QString &value, bool removed);
+
+    // 按顺序重放日志文件，返回重放的记录数（文件不存在时为0）
+    int replayJournal(const QString &filePath);
+
+    // 当前日志 / 压缩中（已轮转）的日志
+    static QString journalPath();
+    static QString rotatedJournalPath();
+
     QMap<QString, QString> m_modTypes;   // PackageId -> Type
     QMap<QString, QString> m_modRemarks; // PackageId -> Remark
     QStringList m_types;                 // Mod类型列表
     QStringList m_typePriority;          // 类型优先级列表（从高到低）
 
+    QFile m_journal;               // 当前日志（追加模式，按需打开）
+    int m_journalRecords = 0;      // 当前日志中的记录数
+    bool m_snapshotLoaded = false; // 快照（或旧版JSON）是否已成功加载，未加载时不压缩日志
+    QFuture<bool> m_compaction;    // 最近一次压缩（快照写入并删除轮转日志）
+
     // 文件名常量
     static const QString MOD_DATA_FILE;
     static const QString TYPES_FILE;
     static const QString TYPE_PRIORITY_FILE;
+    static const QString MOD_DATA_JOURNAL_FILE;
+
+    // 旧版JSON文件名（找不到CBOR文件时读取并迁移）
+    static const QString LEGACY_MOD_DATA_FILE;
+    static const QString LEGACY_TYPES_FILE;
+    static const QString LEGACY_TYPE_PRIORITY_FILE;
+
+    // 日志记录数达到该值时在后台压缩
+    static constexpr int JOURNAL_COMPACT_THRESHOLD = 1000;
 };
 
 #endif // USERDATAMANAGER_H
@@ -1,50 +1,200 @@
 #include "WorkshopScanner.h"
+#include "AboutXmlParser.h"
+#include "ModCatalogCache.h"
+#include "ScanProgress.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QPair>
+#include <QRegularExpression>
 #include <QSettings>
-#include <QXmlStreamReader>
+#include <QStorageInfo>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace
+{
+    // 每个设备的并发读取数量：SSD可以从更深的队列中获益，机械硬盘并发过多会增加寻道
+    constexpr int IO_THREADS_PER_DEVICE = 4;
+
+    // 单个待扫描的Mod目录
+    struct ScanTask
+    {
+        QString modDirPath;
+        QString workshopId; // 为空表示本地Mod
+    };
+}
 
 WorkshopScanner::WorkshopScanner()
-    : m_workshopPath(getDefaultWorkshopPath())
+    : m_workshopPaths(findWorkshopPaths(detectSteamPath()))
 {
 }
 
 WorkshopScanner::WorkshopScanner(const QString &workshopPath)
-    : m_workshopPath(workshopPath)
+    : m_workshopPaths{workshopPath}
+{
+}
+
+WorkshopScanner::~WorkshopScanner()
 {
+    qDeleteAll(m_ioPools);
 }
 
 void WorkshopScanner::setWorkshopPath(const QString &path)
 {
-    m_workshopPath = path;
+    m_workshopPaths = QStringList{path};
 }
 
-bool WorkshopScanner::scanAllMods()
+void WorkshopScanner::setWorkshopPaths(const QStringList &paths)
+{
+    m_workshopPaths = paths;
+}
+
+void WorkshopScanner::setLocalModsPath(const QString &path)
+{
+    m_localModsPath = path;
+}
+
+QStringList WorkshopScanner::getModRoots() const
+{
+    QStringList roots;
+    for (const QString &path : m_workshopPaths)
+    {
+        if (!path.isEmpty())
+        {
+            roots.append(QDir::cleanPath(path));
+        }
+    }
+    if (!m_localModsPath.isEmpty())
+    {
+        roots.append(QDir::cleanPath(m_localModsPath));
+    }
+    roots.removeDuplicates();
+    return roots;
+}
+
+bool WorkshopScanner::scanAllMods(ScanProgress *progress)
 {
     clear();
 
-    QDir workshopDir(m_workshopPath);
-    if (!workshopDir.exists())
+    // 收集所有根目录下的Mod目录，并按根目录所在设备分组
+    QList<ScanTask> tasks;
+    QMap<QThreadPool *, QList<int>> tasksByPool;
+    bool anyRootExists = false;
+
+    for (const QString &rootPath : getModRoots())
+    {
+        QDir rootDir(rootPath);
+        if (!rootDir.exists())
+        {
+            continue;
+        }
+        anyRootExists = true;
+
+        // 工坊目录下每个目录名是Steam WorkshopId，本地Mod目录名没有特殊含义
+        const bool workshopRoot = isWorkshopRoot(rootPath);
+        QThreadPool *pool = m_parallelScan ? ioPoolForPath(rootPath) : nullptr;
+
+        for (const QString &dirName : rootDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        {
+            if (pool)
+            {
+                tasksByPool[pool].append(tasks.size());
+            }
+            tasks.append({rootDir.absoluteFilePath(dirName), workshopRoot ? dirName : QString()});
+        }
+    }
+
+    if (!anyRootExists)
     {
         return false;
     }
 
-    // 获取所有Mod目录（每个目录名是Steam WorkshopId）
-    QStringList modDirs = workshopDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    if (progress)
+    {
+        progress->addFound(tasks.size());
+    }
+
+    const std::atomic<bool> *cancelFlag = progress ? progress->getCancelFlag() : nullptr;
+    auto scanOne = [this, progress, cancelFlag](const ScanTask &task) -> ModItem *
+    {
+        // 已取消时剩余目录直接跳过，不再访问磁盘
+        if (cancelFlag && cancelFlag->load(std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+
+        ModItem *mod = scanModDirectory(task.modDirPath, task.workshopId, cancelFlag);
+        if (progress)
+        {
+            progress->markDone(mod); // 解析完成后立即发布，不等待合并阶段
+        }
+        return mod;
+    };
 
-    for (const QString &workshopId : modDirs)
+    // 解析阶段：并行模式下每个设备的目录交给该设备的线程池，各设备同时进行；
+    // 结果按tasks的顺序放回，保证与串行扫描一致
+    QList<ModItem *> parsedMods(tasks.size(), nullptr);
+    if (m_parallelScan)
     {
-        QString modDirPath = workshopDir.absoluteFilePath(workshopId);
-        ModItem *mod = scanModDirectory(modDirPath, workshopId);
+        QList<QPair<QList<int>, QFuture<ModItem *>>> deviceScans;
+        for (auto it = tasksByPool.cbegin(); it != tasksByPool.cend(); ++it)
+        {
+            QList<ScanTask> deviceTasks;
+            deviceTasks.reserve(it.value().size());
+            for (int index : it.value())
+            {
+                deviceTasks.append(tasks[index]);
+            }
+            deviceScans.append({it.value(), QtConcurrent::mapped(it.key(), std::move(deviceTasks), scanOne)});
+        }
+
+        for (auto &deviceScan : deviceScans)
+        {
+            const QList<ModItem *> results = deviceScan.second.results(); // 等待该设备完成
+            for (int i = 0; i < results.size(); ++i)
+            {
+                parsedMods[deviceScan.first[i]] = results[i];
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < tasks.size(); ++i)
+        {
+            parsedMods[i] = scanOne(tasks[i]);
+        }
+    }
+
+    // 被取消时丢弃本次的全部结果，扫描器保持清空状态
+    if (progress && progress->isCancelled())
+    {
+        qDeleteAll(parsedMods);
+        return false;
+    }
+
+    // 合并阶段：在当前线程按固定顺序写入缓存和映射
+    for (int i = 0; i < tasks.size(); ++i)
+    {
+        const ScanTask &task = tasks[i];
+        ModItem *mod = parsedMods[i];
 
         if (mod && mod->isValid())
         {
             mod->packageId = mod->packageId.toLower();
-            mod->steamId = workshopId;
+            if (!task.workshopId.isEmpty())
+            {
+                mod->steamId = task.workshopId;
+                m_workshopIdMap[task.workshopId] = mod;
+            }
             m_scannedMods.append(mod);
-            m_packageIdMap[mod->packageId] = mod;
-            m_workshopIdMap[workshopId] = mod;
+            m_modDirMap[QDir::cleanPath(task.modDirPath)] = mod;
+
+            // 同一PackageId出现在多个目录时保留先扫描到的，重复由ModManager统一处理
+            if (!m_packageIdMap.contains(mod->packageId))
+            {
+                m_packageIdMap[mod->packageId] = mod;
+            }
         }
         else if (mod)
         {
@@ -55,6 +205,96 @@ bool WorkshopScanner::scanAllMods()
     return true;
 }
 
+ModDirectoryRescan WorkshopScanner::rescanModDirectory(const QString &modDirPath)
+{
+    ModDirectoryRescan result;
+
+    const QString dirPath = QDir::cleanPath(modDirPath);
+    const QString workshopId = isWorkshopRoot(QFileInfo(dirPath).path()) ? QFileInfo(dirPath).fileName() : QString();
+    ModItem *existing = m_modDirMap.value(dirPath, nullptr);
+
+    ModItem *fresh = nullptr;
+    if (QDir(dirPath).exists())
+    {
+        fresh = scanModDirectory(dirPath, workshopId);
+        if (fresh && !fresh->isValid())
+        {
+            delete fresh;
+            fresh = nullptr;
+        }
+    }
+
+    if (fresh)
+    {
+        fresh->packageId = fresh->packageId.toLower();
+        if (!workshopId.isEmpty())
+        {
+            fresh->steamId = workshopId;
+        }
+    }
+
+    if (existing && !fresh)
+    {
+        // Mod目录被删除或About.xml失效
+        m_scannedMods.removeOne(existing);
+        m_modDirMap.remove(dirPath);
+        if (!workshopId.isEmpty())
+        {
+            m_workshopIdMap.remove(workshopId);
+        }
+        if (m_packageIdMap.value(existing->packageId) == existing)
+        {
+            m_packageIdMap.remove(existing->packageId);
+        }
+
+        result.change = ModDirectoryRescan::Removed;
+        result.mod = existing;
+        result.oldPackageId = existing->packageId;
+    }
+    else if (existing && fresh)
+    {
+        // 原地更新，保持ModItem指针不变，用户数据（备注和类型）保留
+        result.oldPackageId = existing->packageId;
+        if (m_packageIdMap.value(existing->packageId) == existing)
+        {
+            m_packageIdMap.remove(existing->packageId);
+        }
+
+        const QString remark = existing->remark;
+        const QString type = existing->type;
+        *existing = std::move(*fresh);
+        existing->remark = remark;
+        existing->type = type;
+        delete fresh;
+
+        if (!m_packageIdMap.contains(existing->packageId))
+        {
+            m_packageIdMap[existing->packageId] = existing;
+        }
+
+        result.change = ModDirectoryRescan::Updated;
+        result.mod = existing;
+    }
+    else if (fresh)
+    {
+        m_scannedMods.append(fresh);
+        m_modDirMap[dirPath] = fresh;
+        if (!workshopId.isEmpty())
+        {
+            m_workshopIdMap[workshopId] = fresh;
+        }
+        if (!m_packageIdMap.contains(fresh->packageId))
+        {
+            m_packageIdMap[fresh->packageId] = fresh;
+        }
+
+        result.change = ModDirectoryRescan::Added;
+        result.mod = fresh;
+    }
+
+    return result;
+}
+
 ModItem *WorkshopScanner::findModByPackageId(const QString &packageId) const
 {
     return m_packageIdMap.value(packageId, nullptr);
@@ -72,6 +312,7 @@ void WorkshopScanner::clear()
     m_scannedMods.clear();
     m_packageIdMap.clear();
     m_workshopIdMap.clear();
+    m_modDirMap.clear();
 }
 
 QString WorkshopScanner::detectSteamPath()
@@ -114,7 +355,8 @@ QString WorkshopScanner::getDefaultWorkshopPath()
     return QDir(steamPath).absoluteFilePath("steamapps/workshop/content/294100");
 }
 
-ModItem *WorkshopScanner::scanModDirectory(const QString &modDirPath, const QString &workshopId)
+ModItem *WorkshopScanner::scanModDirectory(const QString &modDirPath, const QString &workshopId,
+                                           const std::atomic<bool> *cancelFlag)
 {
     // 检查About.xml文件是否存在
     QString aboutXmlPath = QDir(modDirPath).absoluteFilePath("About/About.xml");
@@ -124,419 +366,121 @@ ModItem *WorkshopScanner::scanModDirectory(const QString &modDirPath, const QStr
         return nullptr;
     }
 
-    ModItem *mod = new ModItem();
-
-    if (!parseAboutXml(mod, aboutXmlPath))
-    {
-        delete mod;
-        return nullptr;
-    }
-
-    // 标记为非官方DLC（这是来自Steam创意工坊的mod）
-    mod->isOfficialDLC = false;
-    mod->sourcePath = modDirPath;
-
-    return mod;
-}
+    ModItem *mod = nullptr;
 
-bool WorkshopScanner::parseAboutXml(ModItem *mod, const QString &aboutXmlPath)
-{
-    QFile file(aboutXmlPath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (m_catalogCache)
     {
-        return false;
-    }
-
-    QXmlStreamReader xml(&file);
-    int depth = 0; // 跟踪 XML 深度，确保只读取顶层元素
-
-    while (!xml.atEnd() && !xml.hasError())
-    {
-        QXmlStreamReader::TokenType token = xml.readNext();
-
-        if (token == QXmlStreamReader::StartElement)
+        // 优先从解析缓存读取，About.xml未变化时不重新解析
+        mod = m_catalogCache->loadOrParse(modDirPath, aboutXmlPath,
+                                          [cancelFlag](ModItem *item, const QByteArray &data)
+                                          { return AboutXmlParser::parse(item, data, cancelFlag); });
+        if (!mod)
         {
-            depth++;
-            QString elementName = xml.name().toString();
-
-            // 只处理 ModMetaData 直接子元素（深度为2）
-            if (depth == 2)
-            {
-                if (elementName == "name")
-                {
-                    mod->name = xml.readElementText();
-                    depth--; // readElementText 会读取到结束标签
-                }
-                else if (elementName == "author" || elementName == "authors")
-                {
-                    mod->author = xml.readElementText();
-                    depth--;
-                }
-                else if (elementName == "description")
-                {
-                    mod->description = xml.readElementText();
-                    depth--;
-                }
-                else if (elementName == "packageId")
-                {
-                    // 只在顶层读取 packageId
-                    QString packageId = xml.readElementText();
-                    mod->packageId = packageId;
-                    mod->identifier = packageId;
-                    depth--;
-                }
-                else if (elementName == "url")
-                {
-                    mod->url = xml.readElementText();
-                    depth--;
-                }
-                else if (elementName == "supportedVersions")
-                {
-                    parseSupportedVersions(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "modDependencies")
-                {
-                    parseModDependencies(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "modDependenciesByVersion")
-                {
-                    parseModDependenciesByVersion(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "loadBefore")
-                {
-                    parseLoadBefore(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "loadAfter")
-                {
-                    parseLoadAfter(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "loadBeforeByVersion")
-                {
-                    parseLoadBeforeByVersion(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "loadAfterByVersion")
-                {
-                    parseLoadAfterByVersion(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "forceLoadBefore")
-                {
-                    parseForceLoadBefore(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "forceLoadAfter")
-                {
-                    parseForceLoadAfter(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "incompatibleWith")
-                {
-                    parseIncompatibleWith(xml, mod);
-                    depth--;
-                }
-                else if (elementName == "incompatibleWithByVersion")
-                {
-                    parseIncompatibleWithByVersion(xml, mod);
-                    depth--;
-                }
-            }
-        }
-        else if (token == QXmlStreamReader::EndElement)
-        {
-            depth--;
+            return nullptr;
         }
     }
-
-    file.close();
-
-    return !xml.hasError() && mod->isValid();
-}
-
-void WorkshopScanner::parseSupportedVersions(QXmlStreamReader &xml, ModItem *mod)
-{
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "supportedVersions"))
+    else
     {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li")
-        {
-            mod->addSupportedVersion(xml.readElementText());
-        }
-    }
-}
+        mod = new ModItem();
 
-void WorkshopScanner::parseModDependencies(QXmlStreamReader &xml, ModItem *mod)
-{
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "modDependencies"))
-    {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li")
-        {
-            QString depPackageId = parseDependencyItem(xml);
-            if (!depPackageId.isEmpty())
-            {
-                mod->addDependency(depPackageId);
-            }
-        }
-    }
-}
-
-void WorkshopScanner::parseModDependenciesByVersion(QXmlStreamReader &xml, ModItem *mod)
-{
-    // 跳过整个 modDependenciesByVersion 块，收集所有依赖
-    QSet<QString> allDependencies;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "modDependenciesByVersion"))
-    {
-        xml.readNext();
-
-        // 处理版本块（如 v1.2, v1.3 等）
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v"))
+        if (!AboutXmlParser::parseFile(mod, aboutXmlPath, cancelFlag))
         {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag))
-            {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li")
-                {
-                    QString depPackageId = parseDependencyItem(xml);
-                    if (!depPackageId.isEmpty())
-                    {
-                        allDependencies.insert(depPackageId);
-                    }
-                }
-            }
+            delete mod;
+            return nullptr;
         }
     }
 
-    // 将所有收集的依赖添加到 mod
-    for (const QString &dep : allDependencies)
-    {
-        mod->addDependency(dep);
-    }
-}
-
-QString WorkshopScanner::parseDependencyItem(QXmlStreamReader &xml)
-{
-    QString packageId;
-
-    // 读取 <li> 的内容，可能是直接的文本或包含 <packageId> 子元素
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "li"))
-    {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement)
-        {
-            if (xml.name() == "packageId")
-            {
-                packageId = xml.readElementText();
-                // 找到 packageId 后可以跳出
-                break;
-            }
-        }
-        else if (xml.tokenType() == QXmlStreamReader::Characters)
-        {
-            // 如果是直接文本（旧格式）
-            QString text = xml.text().toString().trimmed();
-            if (!text.isEmpty())
-            {
-                packageId = text;
-            }
-        }
-    }
-
-    // 确保读取到 </li>
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "li"))
-    {
-        xml.readNext();
-    }
-
-    return packageId;
-}
-
-void WorkshopScanner::parseLoadBefore(QXmlStreamReader &xml, ModItem *mod)
-{
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadBefore"))
-    {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li")
-        {
-            mod->addLoadBefore(xml.readElementText());
-        }
-    }
-}
+    // 标记为非官方DLC（这是来自Steam创意工坊或本地Mods目录的mod）
+    mod->isOfficialDLC = false;
+    mod->sourcePath = modDirPath;
+    mod->source = workshopId.isEmpty() ? ModSource::Local : ModSource::Workshop;
 
-void WorkshopScanner::parseLoadAfter(QXmlStreamReader &xml, ModItem *mod)
-{
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadAfter"))
-    {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li")
-        {
-            mod->addLoadAfter(xml.readElementText());
-        }
-    }
+    return mod;
 }
 
-void WorkshopScanner::parseLoadBeforeByVersion(QXmlStreamReader &xml, ModItem *mod)
+QStringList WorkshopScanner::findSteamLibraries(const QString &steamPath)
 {
-    QSet<QString> allLoadBefore;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadBeforeByVersion"))
+    QStringList libraries;
+    if (steamPath.isEmpty())
     {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v"))
-        {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag))
-            {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li")
-                {
-                    allLoadBefore.insert(xml.readElementText());
-                }
-            }
-        }
+        return libraries;
     }
+    libraries.append(QDir::cleanPath(steamPath));
 
-    for (const QString &item : allLoadBefore)
+    QFile file(QDir(steamPath).absoluteFilePath("steamapps/libraryfolders.vdf"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
     {
-        mod->addLoadBefore(item);
+        return libraries;
     }
-}
-
-void WorkshopScanner::parseLoadAfterByVersion(QXmlStreamReader &xml, ModItem *mod)
-{
-    QSet<QString> allLoadAfter;
+    const QString content = QString::fromUtf8(file.readAll());
+    file.close();
 
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "loadAfterByVersion"))
+    // 新格式: "path"  "D:\\SteamLibrary"；旧格式: "1"  "D:\\SteamLibrary"
+    // 数字键也会匹配到 "apps" 中的条目，只接受存在steamapps目录的路径
+    static const QRegularExpression pathPattern(QStringLiteral("\"(?:path|\\d+)\"\\s+\"([^\"]+)\""));
+    QRegularExpressionMatchIterator it = pathPattern.globalMatch(content);
+    while (it.hasNext())
     {
-        xml.readNext();
+        QString path = it.next().captured(1);
+        path.replace("\\\\", "\\");
+        path = QDir::cleanPath(QDir::fromNativeSeparators(path));
 
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v"))
+        if (QDir(path).exists("steamapps") && !libraries.contains(path, Qt::CaseInsensitive))
         {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag))
-            {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li")
-                {
-                    allLoadAfter.insert(xml.readElementText());
-                }
-            }
+            libraries.append(path);
         }
     }
 
-    for (const QString &item : allLoadAfter)
-    {
-        mod->addLoadAfter(item);
-    }
+    return libraries;
 }
 
-void WorkshopScanner::parseForceLoadBefore(QXmlStreamReader &xml, ModItem *mod)
+QStringList WorkshopScanner::findWorkshopPaths(const QString &steamPath)
 {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "forceLoadBefore"))
+    QStringList workshopPaths;
+    const QStringList libraries = findSteamLibraries(steamPath);
+    for (int i = 0; i < libraries.size(); ++i)
     {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li")
+        // RimWorld的Steam AppId是294100
+        const QString path = QDir(libraries[i]).absoluteFilePath("steamapps/workshop/content/294100");
+        if (i == 0 || QDir(path).exists())
         {
-            mod->addForceLoadBefore(xml.readElementText());
+            workshopPaths.append(path);
         }
     }
+    return workshopPaths;
 }
 
-void WorkshopScanner::parseForceLoadAfter(QXmlStreamReader &xml, ModItem *mod)
+QThreadPool *WorkshopScanner::ioPoolForPath(const QString &rootPath)
 {
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "forceLoadAfter"))
+    // 以卷设备标识分组；无法识别时退回根路径本身
+    QStorageInfo storage(rootPath);
+    QString device = storage.isValid() ? QString::fromUtf8(storage.device()) : QString();
+    if (device.isEmpty())
     {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li")
-        {
-            mod->addForceLoadAfter(xml.readElementText());
-        }
+        device = rootPath;
     }
-}
 
-void WorkshopScanner::parseIncompatibleWith(QXmlStreamReader &xml, ModItem *mod)
-{
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "incompatibleWith"))
+    QThreadPool *pool = m_ioPools.value(device, nullptr);
+    if (!pool)
     {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name() == "li")
-        {
-            mod->addIncompatibleWith(xml.readElementText());
-        }
+        pool = new QThreadPool();
+        pool->setMaxThreadCount(IO_THREADS_PER_DEVICE);
+        m_ioPools.insert(device, pool);
     }
+    return pool;
 }
 
-void WorkshopScanner::parseIncompatibleWithByVersion(QXmlStreamReader &xml, ModItem *mod)
+bool WorkshopScanner::isWorkshopRoot(const QString &rootPath) const
 {
-    QSet<QString> allIncompatible;
-
-    while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-             xml.name() == "incompatibleWithByVersion"))
+    const QString cleanRoot = QDir::cleanPath(rootPath);
+    for (const QString &path : m_workshopPaths)
     {
-        xml.readNext();
-
-        if (xml.tokenType() == QXmlStreamReader::StartElement &&
-            xml.name().toString().startsWith("v"))
+        if (!path.isEmpty() && QDir::cleanPath(path) == cleanRoot)
         {
-            QString versionTag = xml.name().toString();
-
-            while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
-                     xml.name() == versionTag))
-            {
-                xml.readNext();
-                if (xml.tokenType() == QXmlStreamReader::StartElement &&
-                    xml.name() == "li")
-                {
-                    allIncompatible.insert(xml.readElementText());
-                }
-            }
+            return true;
         }
     }
-
-    for (const QString &item : allIncompatible)
-    {
-        mod->addIncompatibleWith(item);
-    }
+    return false;
 }
 
 QString WorkshopScanner::getSteamPathFromRegistry()
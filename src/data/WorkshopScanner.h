@@ -5,15 +5,23 @@
 #include <QList>
 #include <QMap>
 #include <QString>
-#include <QXmlStreamReader>
+#include <atomic>
 
 /**
  * @brief Steam创意工坊Mod扫描器
  *
- * 负责扫描Steam创意工坊目录，读取Mod的About.xml文件
- * Steam工坊路径: {Steam安装路径}\steamapps\workshop\content\294100
+ * 负责扫描Steam创意工坊目录和本地Mod目录，读取Mod的About.xml文件
+ * Steam工坊路径: {Steam库路径}\steamapps\workshop\content\294100（每个Steam库一个）
+ * 本地Mod路径: {游戏安装路径}\Mods
  * 每个Mod目录包含: About\About.xml
+ *
+ * 并行扫描时按根目录所在的设备分组，每个设备使用独立的线程池（I/O队列），
+ * 不同磁盘上的Steam库同时读取，同一磁盘上的并发读取数量受限
  */
+class ModCatalogCache;
+class QThreadPool;
+class ScanProgress;
+
 class WorkshopScanner
 {
 public:
@@ -21,18 +29,46 @@ public:
 
     explicit WorkshopScanner(const QString &workshopPath);
 
-    // 设置Steam创意工坊路径
+    ~WorkshopScanner();
+
+    // 设置Steam创意工坊路径（只使用一个工坊目录）
     void setWorkshopPath(const QString &path);
 
-    QString getWorkshopPath() const { return m_workshopPath; }
+    // 获取主工坊路径（第一个工坊目录）
+    QString getWorkshopPath() const { return m_workshopPaths.value(0); }
+
+    // 设置所有工坊目录（每个Steam库一个）
+    void setWorkshopPaths(const QStringList &paths);
+
+    QStringList getWorkshopPaths() const { return m_workshopPaths; }
+
+    // 设置本地Mod目录（{游戏安装路径}/Mods），为空时不扫描
+    void setLocalModsPath(const QString &path);
+
+    QString getLocalModsPath() const { return m_localModsPath; }
+
+    // 获取所有扫描根目录（工坊目录在前，本地Mod目录在后）
+    QStringList getModRoots() const;
 
-    // 扫描所有Mod
-    bool scanAllMods();
+    // 设置是否并行扫描（默认开启，按设备分组使用独立线程池解析各Mod目录）
+    void setParallelScan(bool enabled) { m_parallelScan = enabled; }
 
-    // 获取扫描到的Mod列表
+    bool isParallelScan() const { return m_parallelScan; }
+
+    // 设置解析缓存（可为nullptr，缓存对象由调用者持有）
+    void setCatalogCache(ModCatalogCache *cache) { m_catalogCache = cache; }
+
+    // 扫描所有Mod（progress不为空时发布扫描进度和解析完成的Mod；被取消时丢弃结果并返回false）
+    // 任一根目录存在即返回true
+    bool scanAllMods(ScanProgress *progress = nullptr);
+
+    // 增量重扫单个Mod目录（工坊或本地Mod目录下的一级目录），原地更新扫描结果
+    ModDirectoryRescan rescanModDirectory(const QString &modDirPath);
+
+    // 获取扫描到的Mod列表（按根目录顺序，包含同一PackageId的重复Mod）
     QList<ModItem *> getScannedMods() const { return m_scannedMods; }
 
-    // 根据PackageId查找Mod
+    // 根据PackageId查找Mod（重复时返回先扫描到的）
     ModItem *findModByPackageId(const QString &packageId) const;
 
     // 根据WorkshopId查找Mod
@@ -47,34 +83,37 @@ public:
     // 获取默认工坊路径
     static QString getDefaultWorkshopPath();
 
+    // 读取 steamapps/libraryfolders.vdf，返回所有Steam库路径（Steam安装路径在第一个）
+    static QStringList findSteamLibraries(const QString &steamPath);
+
+    // 返回所有Steam库中的RimWorld工坊目录（Steam安装路径下的目录总是包含，其他库只包含存在的目录）
+    static QStringList findWorkshopPaths(const QString &steamPath);
+
 private:
-    QString m_workshopPath;                   // Steam创意工坊路径
-    QList<ModItem *> m_scannedMods;           // 扫描到的Mod列表
-    QMap<QString, ModItem *> m_packageIdMap;  // PackageId到Mod的映射
-    QMap<QString, ModItem *> m_workshopIdMap; // WorkshopId到Mod的映射
-
-    // 扫描单个Mod目录
-    ModItem *scanModDirectory(const QString &modDirPath, const QString &workshopId);
-
-    // 解析About.xml文件
-    bool parseAboutXml(ModItem *mod, const QString &aboutXmlPath);
-
-    // XML 解析辅助方法
-    void parseSupportedVersions(QXmlStreamReader &xml, ModItem *mod);
-    void parseModDependencies(QXmlStreamReader &xml, ModItem *mod);
-    void parseModDependenciesByVersion(QXmlStreamReader &xml, ModItem *mod);
-    QString parseDependencyItem(QXmlStreamReader &xml);
-    void parseLoadBefore(QXmlStreamReader &xml, ModItem *mod);
-    void parseLoadAfter(QXmlStreamReader &xml, ModItem *mod);
-    void parseLoadBeforeByVersion(QXmlStreamReader &xml, ModItem *mod);
-    void parseLoadAfterByVersion(QXmlStreamReader &xml, ModItem *mod);
-    void parseForceLoadBefore(QXmlStreamReader &xml, ModItem *mod);
-    void parseForceLoadAfter(QXmlStreamReader &xml, ModItem *mod);
-    void parseIncompatibleWith(QXmlStreamReader &xml, ModItem *mod);
-    void parseIncompatibleWithByVersion(QXmlStreamReader &xml, ModItem *mod);
+    QStringList m_workshopPaths;               // Steam创意工坊路径（每个Steam库一个）
+    QString m_localModsPath;                   // 本地Mod目录
+    QList<ModItem *> m_scannedMods;            // 扫描到的Mod列表
+    QMap<QString, ModItem *> m_packageIdMap;   // PackageId到Mod的映射
+    QMap<QString, ModItem *> m_workshopIdMap;  // WorkshopId到Mod的映射
+    QMap<QString, ModItem *> m_modDirMap;      // Mod目录路径到Mod的映射（用于增量重扫）
+    bool m_parallelScan = true;                // 是否并行解析About.xml
+    ModCatalogCache *m_catalogCache = nullptr; // 解析缓存（不持有）
+    QMap<QString, QThreadPool *> m_ioPools;    // 设备标识到I/O线程池的映射（持有）
+
+    // 扫描单个Mod目录（workshopId为空表示本地Mod）
+    ModItem *scanModDirectory(const QString &modDirPath, const QString &workshopId,
+                              const std::atomic<bool> *cancelFlag = nullptr);
+
+    // 获取根目录所在设备的I/O线程池
+    QThreadPool *ioPoolForPath(const QString &rootPath);
+
+    // 判断根目录是否为工坊目录
+    bool isWorkshopRoot(const QString &rootPath) const;
 
     // 辅助方法：从注册表读取Steam路径（Windows）
     static QString getSteamPathFromRegistry();
+
+    Q_DISABLE_COPY(WorkshopScanner)
 };
 
 #endif // WORKSHOPSCANNER_H
@@ -0,0 +1,1210 @@
+#include "benchmark_functions.h"
+#include "../data/AboutXmlParser.h"
+#include "../data/ActiveModList.h"
+#include "../data/MappedFile.h"
+#include "../data/ModDependencyGraph.h"
+#include "../data/ModItem.h"
+#include "../data/ModSorter.h"
+#include "../data/WorkshopScanner.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QQueue>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QXmlStreamReader>
+#include <iterator>
+
+namespace
+{
+    // 辅助函数：打印分隔线
+    void printBenchmarkSeparator(const QString &title)
+    {
+        qDebug() << "\n"
+                 << QString(60, '=');
+        qDebug() << title;
+        qDebug() << QString(60, '=');
+    }
+
+    // 辅助函数：收集语料目录下的所有 About/About.xml 路径
+    QStringList findAboutXmlFiles(const QString &corpusPath)
+    {
+        QStringList paths;
+        QDirIterator it(corpusPath, {"About.xml"}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+        {
+            const QString path = it.next();
+            if (QFileInfo(path).dir().dirName() == "About")
+            {
+                paths.append(path);
+            }
+        }
+        return paths;
+    }
+
+    // 辅助函数：收集语料目录下的所有 About/About.xml 内容
+    QList<QByteArray> loadAboutXmlCorpus(const QString &corpusPath)
+    {
+        QList<QByteArray> corpus;
+        for (const QString &path : findAboutXmlFiles(corpusPath))
+        {
+            QFile file(path);
+            if (file.open(QIODevice::ReadOnly))
+            {
+                corpus.append(file.readAll());
+            }
+        }
+        return corpus;
+    }
+
+    // ==================== 原解析器（对照组） ====================
+    // 逐字移植自重构前的 WorkshopScanner::parseAboutXml 及其 parseXxx 辅助函数，
+    // 改动仅限于：从内存数据读取（与新解析器输入相同）、描述保存为QString供比较，
+    // 以及在每个读取循环中检查 hasError()（否则出错后 tokenType() 停在 Invalid，循环永远无法结束）
+
+    QString legacyParseDependencyItem(QXmlStreamReader &xml)
+    {
+        QString packageId;
+
+        // 读取 <li> 的内容，可能是直接的文本或包含 <packageId> 子元素
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "li") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+
+            if (xml.tokenType() == QXmlStreamReader::StartElement)
+            {
+                if (xml.name() == "packageId")
+                {
+                    packageId = xml.readElementText();
+                    // 找到 packageId 后可以跳出
+                    break;
+                }
+            }
+            else if (xml.tokenType() == QXmlStreamReader::Characters)
+            {
+                // 如果是直接文本（旧格式）
+                QString text = xml.text().toString().trimmed();
+                if (!text.isEmpty())
+                {
+                    packageId = text;
+                }
+            }
+        }
+
+        // 确保读取到 </li>
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "li") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+        }
+
+        return packageId;
+    }
+
+    void legacyParseSupportedVersions(QXmlStreamReader &xml, ModItem *mod)
+    {
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "supportedVersions") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name() == "li")
+            {
+                mod->addSupportedVersion(xml.readElementText());
+            }
+        }
+    }
+
+    void legacyParseModDependencies(QXmlStreamReader &xml, ModItem *mod)
+    {
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "modDependencies") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name() == "li")
+            {
+                QString depPackageId = legacyParseDependencyItem(xml);
+                if (!depPackageId.isEmpty())
+                {
+                    mod->addDependency(depPackageId);
+                }
+            }
+        }
+    }
+
+    void legacyParseModDependenciesByVersion(QXmlStreamReader &xml, ModItem *mod)
+    {
+        // 跳过整个 modDependenciesByVersion 块，收集所有依赖
+        QSet<QString> allDependencies;
+
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "modDependenciesByVersion") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+
+            // 处理版本块（如 v1.2, v1.3 等）
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name().toString().startsWith("v"))
+            {
+                QString versionTag = xml.name().toString();
+
+                while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                         xml.name() == versionTag) &&
+                       !xml.hasError())
+                {
+                    xml.readNext();
+                    if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                        xml.name() == "li")
+                    {
+                        QString depPackageId = legacyParseDependencyItem(xml);
+                        if (!depPackageId.isEmpty())
+                        {
+                            allDependencies.insert(depPackageId);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 将所有收集的依赖添加到 mod
+        for (const QString &dep : allDependencies)
+        {
+            mod->addDependency(dep);
+        }
+    }
+
+    void legacyParseLoadBefore(QXmlStreamReader &xml, ModItem *mod)
+    {
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "loadBefore") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name() == "li")
+            {
+                mod->addLoadBefore(xml.readElementText());
+            }
+        }
+    }
+
+    void legacyParseLoadAfter(QXmlStreamReader &xml, ModItem *mod)
+    {
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "loadAfter") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name() == "li")
+            {
+                mod->addLoadAfter(xml.readElementText());
+            }
+        }
+    }
+
+    void legacyParseLoadBeforeByVersion(QXmlStreamReader &xml, ModItem *mod)
+    {
+        QSet<QString> allLoadBefore;
+
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "loadBeforeByVersion") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name().toString().startsWith("v"))
+            {
+                QString versionTag = xml.name().toString();
+
+                while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                         xml.name() == versionTag) &&
+                       !xml.hasError())
+                {
+                    xml.readNext();
+                    if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                        xml.name() == "li")
+                    {
+                        allLoadBefore.insert(xml.readElementText());
+                    }
+                }
+            }
+        }
+
+        for (const QString &item : allLoadBefore)
+        {
+            mod->addLoadBefore(item);
+        }
+    }
+
+    void legacyParseLoadAfterByVersion(QXmlStreamReader &xml, ModItem *mod)
+    {
+        QSet<QString> allLoadAfter;
+
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "loadAfterByVersion") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name().toString().startsWith("v"))
+            {
+                QString versionTag = xml.name().toString();
+
+                while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                         xml.name() == versionTag) &&
+                       !xml.hasError())
+                {
+                    xml.readNext();
+                    if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                        xml.name() == "li")
+                    {
+                        allLoadAfter.insert(xml.readElementText());
+                    }
+                }
+            }
+        }
+
+        for (const QString &item : allLoadAfter)
+        {
+            mod->addLoadAfter(item);
+        }
+    }
+
+    void legacyParseForceLoadBefore(QXmlStreamReader &xml, ModItem *mod)
+    {
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "forceLoadBefore") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name() == "li")
+            {
+                mod->addForceLoadBefore(xml.readElementText());
+            }
+        }
+    }
+
+    void legacyParseForceLoadAfter(QXmlStreamReader &xml, ModItem *mod)
+    {
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "forceLoadAfter") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name() == "li")
+            {
+                mod->addForceLoadAfter(xml.readElementText());
+            }
+        }
+    }
+
+    void legacyParseIncompatibleWith(QXmlStreamReader &xml, ModItem *mod)
+    {
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "incompatibleWith") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name() == "li")
+            {
+                mod->addIncompatibleWith(xml.readElementText());
+            }
+        }
+    }
+
+    void legacyParseIncompatibleWithByVersion(QXmlStreamReader &xml, ModItem *mod)
+    {
+        QSet<QString> allIncompatible;
+
+        while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                 xml.name() == "incompatibleWithByVersion") &&
+               !xml.hasError())
+        {
+            xml.readNext();
+
+            if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                xml.name().toString().startsWith("v"))
+            {
+                QString versionTag = xml.name().toString();
+
+                while (!(xml.tokenType() == QXmlStreamReader::EndElement &&
+                         xml.name() == versionTag) &&
+                       !xml.hasError())
+                {
+                    xml.readNext();
+                    if (xml.tokenType() == QXmlStreamReader::StartElement &&
+                        xml.name() == "li")
+                    {
+                        allIncompatible.insert(xml.readElementText());
+                    }
+                }
+            }
+        }
+
+        for (const QString &item : allIncompatible)
+        {
+            mod->addIncompatibleWith(item);
+        }
+    }
+
+    // description不为空时输出描述（原ModItem::description为常驻QString，这里同样只保存为QString）
+    bool legacyParseAboutXml(ModItem *mod, const QByteArray &data, QString *description = nullptr)
+    {
+        QXmlStreamReader xml(data);
+        QString descriptionText;
+        int depth = 0; // 跟踪 XML 深度，确保只读取顶层元素
+
+        while (!xml.atEnd() && !xml.hasError())
+        {
+            QXmlStreamReader::TokenType token = xml.readNext();
+
+            if (token == QXmlStreamReader::StartElement)
+            {
+                depth++;
+                QString elementName = xml.name().toString();
+
+                // 只处理 ModMetaData 直接子元素（深度为2）
+                if (depth == 2)
+                {
+                    if (elementName == "name")
+                    {
+                        mod->name = xml.readElementText();
+                        depth--; // readElementText 会读取到结束标签
+                    }
+                    else if (elementName == "author" || elementName == "authors")
+                    {
+                        mod->author = xml.readElementText();
+                        depth--;
+                    }
+                    else if (elementName == "description")
+                    {
+                        descriptionText = xml.readElementText();
+                        depth--;
+                    }
+                    else if (elementName == "packageId")
+                    {
+                        // 只在顶层读取 packageId
+                        QString packageId = xml.readElementText();
+                        mod->packageId = packageId;
+                        mod->identifier = packageId;
+                        depth--;
+                    }
+                    else if (elementName == "url")
+                    {
+                        mod->url = xml.readElementText();
+                        depth--;
+                    }
+                    else if (elementName == "supportedVersions")
+                    {
+                        legacyParseSupportedVersions(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "modDependencies")
+                    {
+                        legacyParseModDependencies(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "modDependenciesByVersion")
+                    {
+                        legacyParseModDependenciesByVersion(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "loadBefore")
+                    {
+                        legacyParseLoadBefore(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "loadAfter")
+                    {
+                        legacyParseLoadAfter(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "loadBeforeByVersion")
+                    {
+                        legacyParseLoadBeforeByVersion(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "loadAfterByVersion")
+                    {
+                        legacyParseLoadAfterByVersion(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "forceLoadBefore")
+                    {
+                        legacyParseForceLoadBefore(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "forceLoadAfter")
+                    {
+                        legacyParseForceLoadAfter(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "incompatibleWith")
+                    {
+                        legacyParseIncompatibleWith(xml, mod);
+                        depth--;
+                    }
+                    else if (elementName == "incompatibleWithByVersion")
+                    {
+                        legacyParseIncompatibleWithByVersion(xml, mod);
+                        depth--;
+                    }
+                }
+            }
+            else if (token == QXmlStreamReader::EndElement)
+            {
+                depth--;
+            }
+        }
+
+        if (description)
+        {
+            *description = descriptionText;
+        }
+        return !xml.hasError() && mod->isValid();
+    }
+
+    // 比较两个解析器的结果，返回不一致的字段名
+    QStringList diffParsedFields(const ModItem &legacy, const QString &legacyDescription, const ModItem &parsed)
+    {
+        // 按版本合并的列表经过QSet收集，顺序不固定，按集合比较
+        auto sameItems = [](const QStringList &a, const QStringList &b)
+        {
+            return QSet<QString>(a.begin(), a.end()) == QSet<QString>(b.begin(), b.end());
+        };
+
+        QStringList fields;
+        auto check = [&](const QString &field, bool same)
+        {
+            if (!same)
+            {
+                fields.append(field);
+            }
+        };
+        check("packageId", legacy.packageId == parsed.packageId);
+        check("name", legacy.name == parsed.name);
+        check("author", legacy.author == parsed.author);
+        check("url", legacy.url == parsed.url);
+        check("description", legacyDescription == parsed.getDescription());
+        check("supportedVersions", sameItems(legacy.supportedVersions, parsed.supportedVersions));
+        check("dependencies", sameItems(legacy.dependencies, parsed.dependencies));
+        check("loadBefore", sameItems(legacy.loadBefore, parsed.loadBefore));
+        check("loadAfter", sameItems(legacy.loadAfter, parsed.loadAfter));
+        check("forceLoadBefore", sameItems(legacy.forceLoadBefore, parsed.forceLoadBefore));
+        check("forceLoadAfter", sameItems(legacy.forceLoadAfter, parsed.forceLoadAfter));
+        check("incompatibleWith", sameItems(legacy.incompatibleWith, parsed.incompatibleWith));
+        return fields;
+    }
+
+    // 执行一轮解析，返回成功解析的数量
+    template <typename ParseFn>
+    int runParsePass(const QList<QByteArray> &corpus, ParseFn parseFn)
+    {
+        int parsed = 0;
+        for (const QByteArray &data : corpus)
+        {
+            ModItem mod;
+            if (parseFn(&mod, data))
+            {
+                parsed++;
+            }
+        }
+        return parsed;
+    }
+
+    // 原读取方式：QIODevice::Text 打开，QXmlStreamReader 通过缓冲设备逐块读取
+    bool legacyParseAboutXmlFile(ModItem *mod, const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            return false;
+        }
+
+        QXmlStreamReader xml(&file);
+        while (!xml.atEnd())
+        {
+            if (xml.readNext() == QXmlStreamReader::StartElement && xml.name() == u"packageId")
+            {
+                mod->packageId = xml.readElementText().trimmed();
+            }
+        }
+        return !xml.hasError() && mod->isValid();
+    }
+
+    // 执行一轮读取+解析，返回成功解析的数量
+    template <typename ParseFileFn>
+    int runParseFilePass(const QStringList &paths, ParseFileFn parseFileFn)
+    {
+        int parsed = 0;
+        for (const QString &path : paths)
+        {
+            ModItem mod;
+            if (parseFileFn(&mod, path))
+            {
+                parsed++;
+            }
+        }
+        return parsed;
+    }
+
+    // ==================== 原排序图（对照组） ====================
+    // 与重构前的 ModSorter 相同：QMap<QString, QStringList> 依赖图，每次查询都重新构建
+
+    void legacyBuildDependencyGraph(const QList<ModItem *> &mods,
+                                    QMap<QString, QStringList> &outGraph,
+                                    QMap<QString, int> &outInDegree)
+    {
+        QMap<QString, ModItem *> modMap;
+        for (ModItem *mod : mods)
+        {
+            QString id = mod->packageId.toLower();
+            modMap[id] = mod;
+            outInDegree[id] = 0;
+            outGraph[id] = QStringList();
+        }
+
+        auto addEdges = [&](const QString &modId, const QStringList &ids, bool modFirst)
+        {
+            for (const QString &other : ids)
+            {
+                QString otherId = other.toLower();
+                if (modMap.contains(otherId))
+                {
+                    const QString &from = modFirst ? modId : otherId;
+                    const QString &to = modFirst ? otherId : modId;
+                    outGraph[from].append(to);
+                    outInDegree[to]++;
+                }
+            }
+        };
+
+        for (ModItem *mod : mods)
+        {
+            QString modId = mod->packageId.toLower();
+            addEdges(modId, mod->dependencies, false);
+            addEdges(modId, mod->loadAfter, false);
+            addEdges(modId, mod->loadBefore, true);
+            addEdges(modId, mod->forceLoadAfter, false);
+            addEdges(modId, mod->forceLoadBefore, true);
+        }
+    }
+
+    QList<ModItem *> legacyTopologicalSort(const QList<ModItem *> &mods,
+                                           const QMap<QString, QStringList> &graph,
+                                           QMap<QString, int> inDegree)
+    {
+        QMap<QString, ModItem *> modMap;
+        for (ModItem *mod : mods)
+        {
+            modMap[mod->packageId.toLower()] = mod;
+        }
+
+        QList<ModItem *> result;
+        QQueue<QString> queue;
+        for (auto it = inDegree.begin(); it != inDegree.end(); ++it)
+        {
+            if (it.value() == 0)
+            {
+                queue.enqueue(it.key());
+            }
+        }
+
+        while (!queue.isEmpty())
+        {
+            QString current = queue.dequeue();
+            result.append(modMap[current]);
+            for (const QString &neighbor : graph[current])
+            {
+                inDegree[neighbor]--;
+                if (inDegree[neighbor] == 0)
+                {
+                    queue.enqueue(neighbor);
+                }
+            }
+        }
+
+        if (result.size() != mods.size())
+        {
+            for (ModItem *mod : mods)
+            {
+                if (!result.contains(mod))
+                {
+                    result.append(mod);
+                }
+            }
+        }
+        return result;
+    }
+
+    QStringList legacyCircularDependencies(const QList<ModItem *> &mods)
+    {
+        QMap<QString, QStringList> graph;
+        QMap<QString, int> inDegree;
+        legacyBuildDependencyGraph(mods, graph, inDegree);
+
+        QQueue<QString> queue;
+        for (auto it = inDegree.begin(); it != inDegree.end(); ++it)
+        {
+            if (it.value() == 0)
+            {
+                queue.enqueue(it.key());
+            }
+        }
+        while (!queue.isEmpty())
+        {
+            QString current = queue.dequeue();
+            for (const QString &neighbor : graph[current])
+            {
+                if (--inDegree[neighbor] == 0)
+                {
+                    queue.enqueue(neighbor);
+                }
+            }
+        }
+
+        QStringList circular;
+        for (auto it = inDegree.begin(); it != inDegree.end(); ++it)
+        {
+            if (it.value() > 0)
+            {
+                circular.append(it.key());
+            }
+        }
+        return circular;
+    }
+
+    // 原自动排序流程：检查循环（构建+排序）、获取循环节点（再构建一次）、排序（再构建一次）
+    QList<ModItem *> legacyAutoSort(const QList<ModItem *> &mods)
+    {
+        QMap<QString, QStringList> graph;
+        QMap<QString, int> inDegree;
+        legacyBuildDependencyGraph(mods, graph, inDegree);
+        if (legacyTopologicalSort(mods, graph, inDegree).size() != mods.size())
+        {
+            legacyCircularDependencies(mods);
+        }
+
+        QMap<QString, QStringList> sortGraph;
+        QMap<QString, int> sortInDegree;
+        legacyBuildDependencyGraph(mods, sortGraph, sortInDegree);
+        return legacyTopologicalSort(mods, sortGraph, sortInDegree);
+    }
+
+    // 原类型优先级调整：反复冒泡，只交换不破坏直接约束的相邻元素
+    bool legacyCanSwap(ModItem *mod1, ModItem *mod2)
+    {
+        QString id1 = mod1->packageId.toLower();
+        QString id2 = mod2->packageId.toLower();
+
+        auto references = [](const QStringList &ids, const QString &id)
+        {
+            for (const QString &other : ids)
+            {
+                if (other.toLower() == id)
+                    return true;
+            }
+            return false;
+        };
+
+        return !(references(mod1->dependencies, id2) || references(mod1->loadAfter, id2) ||
+                 references(mod1->loadBefore, id2) || references(mod2->dependencies, id1) ||
+                 references(mod2->loadBefore, id1) || references(mod2->loadAfter, id1));
+    }
+
+    QList<ModItem *> legacyStabilizeSortByTypePriority(const QList<ModItem *> &mods, const QStringList &typePriority)
+    {
+        auto priorityOf = [&typePriority](const QString &type)
+        {
+            int index = typePriority.indexOf(type);
+            return index >= 0 ? index : 99999;
+        };
+
+        QList<ModItem *> result = mods;
+        bool swapped = true;
+        while (swapped)
+        {
+            swapped = false;
+            for (int i = 0; i < result.size() - 1; i++)
+            {
+                if (priorityOf(result[i + 1]->type) < priorityOf(result[i]->type) && legacyCanSwap(result[i], result[i + 1]))
+                {
+                    result.swapItemsAt(i, i + 1);
+                    swapped = true;
+                }
+            }
+        }
+        return result;
+    }
+
+    // 检查排序结果是否满足依赖图中的全部边
+    bool satisfiesConstraints(const ModDependencyGraph &graph, const QList<ModItem *> &sorted)
+    {
+        QHash<const ModItem *, int> position;
+        for (int i = 0; i < sorted.size(); ++i)
+        {
+            position.insert(sorted[i], i);
+        }
+
+        for (int node = 0; node < graph.nodeCount(); ++node)
+        {
+            const int from = position.value(graph.node(node), -1);
+            for (const int *it = graph.successorsBegin(node), *end = graph.successorsEnd(node); it != end; ++it)
+            {
+                if (from < 0 || position.value(graph.node(*it), -1) < from)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // 新自动排序流程：依赖图只构建一次
+    QList<ModItem *> graphAutoSort(const QList<ModItem *> &mods)
+    {
+        const ModDependencyGraph graph(mods);
+        if (ModSorter::hasCircularDependency(graph))
+        {
+            ModSorter::getCircularDependencies(graph);
+        }
+        return ModSorter::sortMods(graph, QStringList());
+    }
+
+    const char *const SYNTHETIC_TYPES[] = {"框架", "核心", "内容", "界面", "补丁"};
+
+    // 生成合成 Mod：每个 Mod 依赖若干编号更小的 Mod，并带有少量 loadBefore/loadAfter
+    // withCycle 为 true 时在末尾两个 Mod 之间加入一条反向依赖形成环
+    QList<ModItem *> makeSyntheticMods(int modCount, bool withCycle)
+    {
+        QRandomGenerator random(20240601);
+        QList<ModItem *> mods;
+        mods.reserve(modCount);
+
+        for (int i = 0; i < modCount; ++i)
+        {
+            ModItem *mod = new ModItem();
+            mod->packageId = QString("Bench.Mod%1").arg(i, 6, 10, QChar('0'));
+            mod->modId = quint32(i);
+            mod->type = QString::fromUtf8(SYNTHETIC_TYPES[random.bounded(int(std::size(SYNTHETIC_TYPES)))]);
+
+            auto link = [&](QStringList &names, QList<quint32> &ids, int target)
+            {
+                const QString name = QString("Bench.Mod%1").arg(target, 6, 10, QChar('0'));
+                if (!names.contains(name))
+                {
+                    names.append(name);
+                    ids.append(quint32(target));
+                }
+            };
+
+            if (i > 0)
+            {
+                const int depCount = random.bounded(4);
+                for (int d = 0; d < depCount; ++d)
+                {
+                    link(mod->dependencies, mod->dependencyIds, random.bounded(i));
+                }
+                if (random.bounded(4) == 0)
+                {
+                    link(mod->loadAfter, mod->loadAfterIds, random.bounded(i));
+                }
+            }
+            if (i + 1 < modCount && random.bounded(8) == 0)
+            {
+                link(mod->loadBefore, mod->loadBeforeIds, i + 1 + random.bounded(modCount - i - 1));
+            }
+            mods.append(mod);
+        }
+
+        if (withCycle && modCount >= 2)
+        {
+            ModItem *first = mods[modCount - 2];
+            first->dependencies.append(mods[modCount - 1]->packageId);
+            first->dependencyIds.append(mods[modCount - 1]->modId);
+            ModItem *second = mods[modCount - 1];
+            second->dependencies.append(first->packageId);
+            second->dependencyIds.append(first->modId);
+        }
+
+        return mods;
+    }
+}
+
+void benchmark_AboutXmlParser(const QString &corpusPath, int iterations)
+{
+    printBenchmarkSeparator("性能测试1：About.xml 解析器");
+
+    QList<QByteArray> corpus = loadAboutXmlCorpus(corpusPath);
+    if (corpus.isEmpty())
+    {
+        qDebug() << "❌ 语料目录中没有 About.xml:" << corpusPath;
+        return;
+    }
+
+    qint64 totalBytes = 0;
+    for (const QByteArray &data : corpus)
+    {
+        totalBytes += data.size();
+    }
+    qDebug() << "语料:" << corpus.size() << "个文件," << totalBytes / 1024 << "KB";
+
+    auto legacyParse = [](ModItem *mod, const QByteArray &data)
+    { return legacyParseAboutXml(mod, data); };
+    auto tableParse = [](ModItem *mod, const QByteArray &data)
+    { return AboutXmlParser::parse(mod, data); };
+
+    // 预热，并逐字段比较两个解析器的结果
+    // （新解析器会去除首尾空白、合并 authors 列表，这些字段上的差异是有意的行为变化）
+    int legacyParsed = 0;
+    int tableParsed = 0;
+    int mismatchedFiles = 0;
+    QMap<QString, int> mismatchByField;
+    for (const QByteArray &data : corpus)
+    {
+        ModItem legacyMod;
+        QString legacyDescription;
+        ModItem tableMod;
+        const bool legacyOk = legacyParseAboutXml(&legacyMod, data, &legacyDescription);
+        const bool tableOk = AboutXmlParser::parse(&tableMod, data);
+        legacyParsed += legacyOk ? 1 : 0;
+        tableParsed += tableOk ? 1 : 0;
+
+        QStringList fields = diffParsedFields(legacyMod, legacyDescription, tableMod);
+        if (legacyOk != tableOk)
+        {
+            fields.prepend("valid");
+        }
+        if (fields.isEmpty())
+        {
+            continue;
+        }
+
+        for (const QString &field : fields)
+        {
+            mismatchByField[field]++;
+        }
+        if (++mismatchedFiles <= 5)
+        {
+            qDebug() << "  结果不一致:" << (tableMod.packageId.isEmpty() ? legacyMod.packageId : tableMod.packageId)
+                     << fields.join(", ");
+        }
+    }
+    qDebug() << "有效解析数: 原解析器" << legacyParsed << "/ 表驱动解析器" << tableParsed;
+    qDebug() << "字段不一致的文件:" << mismatchedFiles << "/" << corpus.size();
+    for (auto it = mismatchByField.cbegin(); it != mismatchByField.cend(); ++it)
+    {
+        qDebug() << "  " << it.key() << ":" << it.value();
+    }
+
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+    {
+        runParsePass(corpus, legacyParse);
+    }
+    const qint64 legacyNs = timer.nsecsElapsed();
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+    {
+        runParsePass(corpus, tableParse);
+    }
+    const qint64 tableNs = timer.nsecsElapsed();
+
+    const double files = double(corpus.size()) * iterations;
+    qDebug() << QString("  原解析器 (if/else + toString): %1 ms, 平均 %2 us/文件")
+                    .arg(legacyNs / 1e6, 0, 'f', 2)
+                    .arg(legacyNs / 1e3 / files, 0, 'f', 2);
+    qDebug() << QString("  AboutXmlParser (常量表分发):   %1 ms, 平均 %2 us/文件")
+                    .arg(tableNs / 1e6, 0, 'f', 2)
+                    .arg(tableNs / 1e3 / files, 0, 'f', 2);
+    if (tableNs > 0)
+    {
+        qDebug() << QString("  加速比: %1x").arg(double(legacyNs) / double(tableNs), 0, 'f', 2);
+    }
+
+    qDebug() << "\n✓ 性能测试1完成";
+}
+
+void benchmark_AboutXmlIo(const QString &corpusPath, int iterations)
+{
+    printBenchmarkSeparator("性能测试2：About.xml 读取方式（缓冲设备 / readAll / 内存映射）");
+
+    const QStringList paths = findAboutXmlFiles(corpusPath);
+    if (paths.isEmpty())
+    {
+        qDebug() << "❌ 语料目录中没有 About.xml:" << corpusPath;
+        return;
+    }
+    qDebug() << "语料:" << paths.size() << "个文件";
+    qDebug() << "注意：第一轮受系统文件缓存影响最大，冷缓存数据请在重启后首次运行时观察";
+
+    const bool previousMode = MappedFile::isMemoryMapEnabled();
+
+    auto timePass = [&](const QString &label, auto parseFileFn)
+    {
+        QElapsedTimer timer;
+        qint64 firstNs = 0;
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+        {
+            QElapsedTimer passTimer;
+            passTimer.start();
+            runParseFilePass(paths, parseFileFn);
+            if (i == 0)
+            {
+                firstNs = passTimer.nsecsElapsed();
+            }
+        }
+        const qint64 totalNs = timer.nsecsElapsed();
+        qDebug() << QString("  %1 首轮 %2 ms, 共 %3 ms, 平均 %4 us/文件")
+                        .arg(label)
+                        .arg(firstNs / 1e6, 0, 'f', 2)
+                        .arg(totalNs / 1e6, 0, 'f', 2)
+                        .arg(totalNs / 1e3 / (double(paths.size()) * iterations), 0, 'f', 2);
+        return totalNs;
+    };
+
+    // 对照组只提取packageId，解析工作量比另外两组少，差距偏保守
+    const qint64 legacyNs = timePass("缓冲设备 (QIODevice::Text):", legacyParseAboutXmlFile);
+
+    auto parseFile = [](ModItem *mod, const QString &path)
+    { return AboutXmlParser::parseFile(mod, path); };
+
+    MappedFile::setMemoryMapEnabled(false);
+    const qint64 readAllNs = timePass("readAll + 完整解析:         ", parseFile);
+
+    MappedFile::setMemoryMapEnabled(true);
+    const qint64 mappedNs = timePass("内存映射 + 完整解析:        ", parseFile);
+
+    MappedFile::setMemoryMapEnabled(previousMode);
+
+    if (mappedNs > 0)
+    {
+        qDebug() << QString("  内存映射相对 readAll: %1x, 相对缓冲设备: %2x")
+                        .arg(double(readAllNs) / double(mappedNs), 0, 'f', 2)
+                        .arg(double(legacyNs) / double(mappedNs), 0, 'f', 2);
+    }
+
+    qDebug() << "\n✓ 性能测试2完成";
+}
+
+void benchmark_ModSorter(int modCount, int iterations)
+{
+    printBenchmarkSeparator(QString("性能测试3：Mod 排序（%1 个合成 Mod）").arg(modCount));
+
+    for (bool withCycle : {false, true})
+    {
+        QList<ModItem *> mods = makeSyntheticMods(modCount, withCycle);
+
+        int edges = 0;
+        {
+            const ModDependencyGraph graph(mods);
+            edges = graph.edgeCount();
+        }
+        qDebug() << (withCycle ? "含环图:" : "无环图:") << mods.size() << "个节点," << edges << "条边";
+
+        // 预热，并校验两种实现的排序结果都满足约束（有环时不校验）
+        const QList<ModItem *> legacySorted = legacyAutoSort(mods);
+        const QList<ModItem *> graphSorted = graphAutoSort(mods);
+        if (!withCycle)
+        {
+            const ModDependencyGraph graph(mods);
+            qDebug() << "满足全部约束: 原实现" << satisfiesConstraints(graph, legacySorted)
+                     << "/ ModDependencyGraph" << satisfiesConstraints(graph, graphSorted);
+        }
+
+        QElapsedTimer timer;
+
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+        {
+            legacyAutoSort(mods);
+        }
+        const qint64 legacyNs = timer.nsecsElapsed();
+
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+        {
+            graphAutoSort(mods);
+        }
+        const qint64 graphNs = timer.nsecsElapsed();
+
+        qDebug() << QString("  原实现 (QMap 字符串图，每次查询重建): 平均 %1 ms")
+                        .arg(legacyNs / 1e6 / iterations, 0, 'f', 2);
+        qDebug() << QString("  ModDependencyGraph (CSR，构建一次):  平均 %1 ms")
+                        .arg(graphNs / 1e6 / iterations, 0, 'f', 2);
+        if (graphNs > 0)
+        {
+            qDebug() << QString("  加速比: %1x").arg(double(legacyNs) / double(graphNs), 0, 'f', 2);
+        }
+
+        qDeleteAll(mods);
+    }
+
+    qDebug() << "\n✓ 性能测试3完成";
+}
+
+void benchmark_ModSortPriority(int modCount, int iterations)
+{
+    printBenchmarkSeparator(QString("性能测试4：类型优先级排序（%1 个合成 Mod）").arg(modCount));
+
+    QList<ModItem *> mods = makeSyntheticMods(modCount, false);
+    QStringList typePriority;
+    for (const char *type : SYNTHETIC_TYPES)
+    {
+        typePriority.append(QString::fromUtf8(type));
+    }
+
+    const ModDependencyGraph graph(mods);
+
+    // 对照组：拓扑排序后反复冒泡；新实现：一次优先队列 Kahn
+    auto legacySort = [&]()
+    {
+        QList<ModItem *> sorted;
+        for (int index : graph.topologicalOrder())
+        {
+            sorted.append(graph.node(index));
+        }
+        return legacyStabilizeSortByTypePriority(sorted, typePriority);
+    };
+    auto prioritySort = [&]()
+    { return ModSorter::sortMods(graph, typePriority); };
+
+    // 预热并校验约束；逆序对数越少，说明类型优先级越接近理想顺序
+    auto inversions = [&typePriority](const QList<ModItem *> &sorted)
+    {
+        qint64 count = 0;
+        QList<int> seen(typePriority.size(), 0);
+        for (const ModItem *mod : sorted)
+        {
+            const int rank = int(typePriority.indexOf(mod->type));
+            for (int lower = rank + 1; lower < seen.size(); ++lower)
+            {
+                count += seen[lower];
+            }
+            seen[rank]++;
+        }
+        return count;
+    };
+    const QList<ModItem *> legacySorted = legacySort();
+    const QList<ModItem *> prioritySorted = prioritySort();
+    qDebug() << "满足全部约束: 冒泡" << satisfiesConstraints(graph, legacySorted)
+             << "/ 优先队列" << satisfiesConstraints(graph, prioritySorted);
+    qDebug() << "类型逆序对: 冒泡" << inversions(legacySorted) << "/ 优先队列" << inversions(prioritySorted);
+
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+    {
+        legacySort();
+    }
+    const qint64 legacyNs = timer.nsecsElapsed();
+
+    timer.start();
+    for (int i = 0; i < iterations; ++i)
+    {
+        prioritySort();
+    }
+    const qint64 priorityNs = timer.nsecsElapsed();
+
+    qDebug() << QString("  冒泡调整 (canSwap + toLower): 平均 %1 ms").arg(legacyNs / 1e6 / iterations, 0, 'f', 2);
+    qDebug() << QString("  优先队列 Kahn:               平均 %1 ms").arg(priorityNs / 1e6 / iterations, 0, 'f', 2);
+    if (priorityNs > 0)
+    {
+        qDebug() << QString("  加速比: %1x").arg(double(legacyNs) / double(priorityNs), 0, 'f', 2);
+    }
+
+    qDeleteAll(mods);
+
+    qDebug() << "\n✓ 性能测试4完成";
+}
+
+void benchmark_ActiveModList(int modCount, int moves)
+{
+    printBenchmarkSeparator(QString("性能测试5：激活列表编辑（%1 个 Mod，%2 次移动）").arg(modCount).arg(moves));
+
+    QStringList packageIds;
+    for (int i = 0; i < modCount; ++i)
+    {
+        packageIds.append(QString("synthetic.Mod%1").arg(i));
+    }
+
+    // 两种实现使用同一组随机操作
+    QList<QPair<int, int>> operations;
+    QRandomGenerator random(42);
+    for (int i = 0; i < moves; ++i)
+    {
+        operations.append({int(random.bounded(modCount)), int(random.bounded(modCount))});
+    }
+
+    QElapsedTimer timer;
+
+    timer.start();
+    QStringList legacy = packageIds;
+    for (const auto &[which, to] : operations)
+    {
+        const QString &packageId = packageIds[which];
+        legacy.move(legacy.indexOf(packageId), to);
+    }
+    const qint64 legacyNs = timer.nsecsElapsed();
+
+    timer.start();
+    ActiveModList list;
+    list.assign(packageIds);
+    for (const auto &[which, to] : operations)
+    {
+        list.move(packageIds[which], to);
+    }
+    const qint64 treapNs = timer.nsecsElapsed();
+
+    qDebug() << "结果一致:" << (legacy == list.toStringList());
+    qDebug() << QString("  QStringList (indexOf + move): 总计 %1 ms").arg(legacyNs / 1e6, 0, 'f', 2);
+    qDebug() << QString("  ActiveModList:                总计 %1 ms").arg(treapNs / 1e6, 0, 'f', 2);
+    if (treapNs > 0)
+    {
+        qDebug() << QString("  加速比: %1x").arg(double(legacyNs) / double(treapNs), 0, 'f', 2);
+    }
+
+    qDebug() << "\n✓ 性能测试5完成";
+}
+
+void runAllBenchmarks()
+{
+    // 排序和激活列表测试使用合成数据，不依赖工坊目录
+    benchmark_ModSorter();
+    benchmark_ModSortPriority();
+    benchmark_ActiveModList();
+
+    QString corpusPath = WorkshopScanner::getDefaultWorkshopPath();
+    if (corpusPath.isEmpty() || !QDir(corpusPath).exists())
+    {
+        qDebug() << "⚠️  未能检测到工坊目录，跳过性能测试";
+        return;
+    }
+
+    benchmark_AboutXmlParser(corpusPath);
+    benchmark_AboutXmlIo(corpusPath);
+}
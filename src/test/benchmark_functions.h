@@ -0,0 +1,65 @@
+#ifndef BENCHMARK_FUNCTIONS_H
+#define BENCHMARK_FUNCTIONS_H
+
+#include <QString>
+
+/**
+ * @file benchmark_functions.h
+ * @brief 性能测试函数声明
+ */
+
+/**
+ * @brief 性能测试1：About.xml 解析器（表驱动解析器 vs 原 if/else 字符串分发）
+ *
+ * @param corpusPath About.xml 语料目录（一般为工坊目录，递归查找 About/About.xml）
+ * @param iterations 重复次数
+ */
+void benchmark_AboutXmlParser(const QString &corpusPath, int iterations = 5);
+
+/**
+ * @brief 性能测试2：About.xml 读取方式（QIODevice::Text 缓冲读取 vs readAll vs QFile::map）
+ *
+ * 通过 MappedFile::setMemoryMapEnabled 切换读取方式，测试结束后恢复原设置。
+ *
+ * @param corpusPath About.xml 语料目录
+ * @param iterations 重复次数（首轮单独输出，用于观察冷缓存）
+ */
+void benchmark_AboutXmlIo(const QString &corpusPath, int iterations = 5);
+
+/**
+ * @brief 性能测试3：Mod 排序（原 QMap 字符串图 vs ModDependencyGraph 压缩稀疏行图）
+ *
+ * 模拟一次自动排序：检查循环依赖、获取循环节点（有环时）、执行排序。
+ * 使用随机生成的合成依赖图，分别测试无环和含环两种情况。
+ *
+ * @param modCount 合成 Mod 数量
+ * @param iterations 重复次数
+ */
+void benchmark_ModSorter(int modCount = 10000, int iterations = 5);
+
+/**
+ * @brief 性能测试4：类型优先级排序（原冒泡调整 vs 优先队列 Kahn）
+ *
+ * 两种实现共用同一张依赖图，同时输出类型优先级逆序对数量，用于比较排序质量。
+ *
+ * @param modCount 合成 Mod 数量
+ * @param iterations 重复次数
+ */
+void benchmark_ModSortPriority(int modCount = 1500, int iterations = 3);
+
+/**
+ * @brief 性能测试5：激活列表编辑（QStringList 线性查找 vs ActiveModList 哈希索引 + 隐式 treap）
+ *
+ * 模拟拖拽调整顺序：每次按 PackageId 查找位置，再移动到随机位置。
+ *
+ * @param modCount 激活 Mod 数量
+ * @param moves 移动次数
+ */
+void benchmark_ActiveModList(int modCount = 1500, int moves = 20000);
+
+/**
+ * @brief 运行所有性能测试（使用自动检测到的工坊目录作为语料）
+ */
+void runAllBenchmarks();
+
+#endif // BENCHMARK_FUNCTIONS_H
@@ -10,15 +10,25 @@
 #include <QFileDialog>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QKeyEvent>
 #include <QMap>
 #include <QMessageBox>
 #include <QProgressDialog>
+#include <QPushButton>
 #include <QSet>
 #include <QStandardPaths>
+#include <QTimer>
 #include <QtConcurrent>
 
+namespace
+{
+    // 扫描期间轮询进度的间隔
+    constexpr int SCAN_POLL_INTERVAL_MS = 100;
+}
+
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), modManager(nullptr), configManager(nullptr), detailPanel(nullptr),
+    : QMainWindow(parent), ui(new Ui::MainWindow), modManager(nullptr), configManager(nullptr),
+      listValidator(nullptr), dependencyResolver(nullptr), detailPanel(nullptr), modWatcher(nullptr),
       currentSelectedMod(nullptr)
 {
     ui->setupUi(this);
@@ -47,6 +57,8 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
     delete ui;
+    delete listValidator;
+    delete dependencyResolver;
     if (modManager)
     {
         delete modManager;
@@ -92,11 +104,15 @@ void MainWindow::setupConnections()
 
     // 详情面板
     connect(detailPanel, &ModDetailPanel::modDetailsChanged, this, &MainWindow::onModDetailChanged);
+
+    // Mod目录变化
+    connect(modWatcher, &ModDirectoryWatcher::modDirectoriesChanged, this, &MainWindow::onModDirectoriesChanged);
 }
 
 void MainWindow::initializeManagers()
 {
     modManager = new ModManager();
+    modWatcher = new ModDirectoryWatcher(this);
 
     // 使用路径配置初始化 ModManager
     if (pathConfig.isValid())
@@ -116,30 +132,112 @@ void MainWindow::initializeManagers()
         configManager = new ModConfigManager();
     }
 
+    listValidator = new ModListValidator(configManager, modManager);
+    dependencyResolver = new DependencyResolver(modManager);
+
     showStatusMessage("初始化中...");
 }
 
 void MainWindow::startScan()
 {
-    // 显示进度对话框
+    // 完整扫描期间停止监视，扫描完成后重建
+    modWatcher->setEnabled(false);
+    modWatcher->clear();
+
+    // 先加载游戏配置，扫描过程中即可跳过已激活的Mod
+    loadGameConfig();
+    currentSelectedMod = nullptr;
+    detailPanel->setModItem(nullptr, modManager);
+    ui->unloadedModsList->clear();
+    ui->loadedModsList->clear();
+    streamedModIds.clear();
+    scanProgress.reset();
+
+    // 扫描线程会修改ModManager的ID表，扫描期间改用已激活的PackageId跳过已加载的Mod
+    for (const QString &packageId : configManager->getActiveMods())
+    {
+        streamedModIds.insert(packageId.toLower());
+    }
+
+    // 显示进度对话框（范围随发现的目录数增长，不能在中途自动关闭）
     QProgressDialog *progressDialog = new QProgressDialog("正在扫描 Mod...", "取消", 0, 0, this);
     progressDialog->setWindowModality(Qt::WindowModal);
     progressDialog->setMinimumDuration(0);
+    progressDialog->setAutoClose(false);
+    progressDialog->setAutoReset(false);
     progressDialog->setValue(0);
 
+    // 按固定频率轮询进度计数器，并把已解析的Mod追加到未加载列表
+    QTimer *pollTimer = new QTimer(this);
+    pollTimer->setInterval(SCAN_POLL_INTERVAL_MS);
+    connect(pollTimer, &QTimer::timeout, this, [this, progressDialog]()
+            {
+        // 请求取消后保留"正在取消扫描..."，部分结果会被丢弃，也不再追加
+        if (scanProgress.isCancelled()) {
+            return;
+        }
+        const int found = scanProgress.getFoundCount();
+        const int done = scanProgress.getDoneCount();
+        if (found > 0) {
+            progressDialog->setMaximum(found);
+            progressDialog->setValue(done);
+            progressDialog->setLabelText(QString("正在扫描 Mod... %1 / %2").arg(done).arg(found));
+        }
+        appendScannedMods(); });
+    pollTimer->start();
+
+    // 取消只设置标志，扫描线程在目录之间和解析过程中检查后尽快退出。
+    // 默认的取消按钮会重置并隐藏对话框，扫描仍在运行时主窗口就可以再次操作，
+    // 因此换成只请求取消的按钮，对话框保持模态直到扫描线程结束
+    QPushButton *cancelButton = new QPushButton("取消", progressDialog);
+    progressDialog->setCancelButton(cancelButton);
+    cancelButton->disconnect(progressDialog);
+    connect(cancelButton, &QPushButton::clicked, this, [this, progressDialog, cancelButton]()
+            {
+        scanProgress.requestCancel();
+        cancelButton->setEnabled(false);
+        progressDialog->setLabelText("正在取消扫描..."); });
+    progressDialog->installEventFilter(this);
+
     // 创建 Future Watcher
     QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
 
-    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, progressDialog]()
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, progressDialog, pollTimer]()
             {
+        pollTimer->stop();
+        pollTimer->deleteLater();
+
+        // 以扫描器是否确认取消为准：最后一次检查之后才点击取消时，扫描已完成且结果已保留
+        const bool cancelled = scanProgress.wasCancelled();
+        progressDialog->removeEventFilter(this);
         progressDialog->close();
 
         bool success = watcher->result();
-        if (success) {
-            loadGameConfig();
+        if (cancelled) {
+            // 部分结果已被ModManager丢弃，列表保持与其一致
+            scanProgress.takePending();
+            streamedModIds.clear();
+            updateModLists();
+            showStatusMessage("扫描已取消，可通过重新扫描加载 Mod");
+        } else if (success) {
+            // 流式显示的条目只是快照，扫描结束后用完整结果（含去重和用户数据）重建列表
+            scanProgress.takePending();
+            streamedModIds.clear();
             updateModLists();
-            showStatusMessage(QString("扫描完成，共找到 %1 个 Mod").arg(modManager->getAllMods().count()));
+            QString message = QString("扫描完成，共找到 %1 个 Mod").arg(modManager->getAllMods().count());
+            const QStringList duplicates = modManager->getDuplicatePackageIds();
+            if (!duplicates.isEmpty()) {
+                // 重复的Mod按 官方 > 本地 > 工坊 的优先级使用
+                message += QString("，%1 个 PackageId 在多个位置重复: %2").arg(duplicates.size()).arg(duplicates.join(", "));
+            }
+            showStatusMessage(message, 8000);
+
+            // 监视Mod目录，后续变化只增量重扫受影响的Mod
+            modWatcher->setRoots(modManager->getWatchRoots());
+            modWatcher->setEnabled(true);
         } else {
+            ui->unloadedModsList->clear();
+            streamedModIds.clear();
             QMessageBox::warning(this, "扫描失败", "无法扫描 Mod，请检查游戏路径设置");
             showStatusMessage("扫描失败");
         }
@@ -149,16 +247,88 @@ void MainWindow::startScan()
 
     // 在后台线程执行扫描
     QFuture<bool> future = QtConcurrent::run([this]()
-                                             { return modManager->scanAll(); });
+                                             { return modManager->scanAll(&scanProgress); });
 
     watcher->setFuture(future);
 }
 
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    QProgressDialog *dialog = qobject_cast<QProgressDialog *>(watched);
+    const bool escape = event->type() == QEvent::KeyPress && static_cast<QKeyEvent *>(event)->key() == Qt::Key_Escape;
+    if (dialog && (escape || event->type() == QEvent::Close))
+    {
+        // 与点击取消按钮相同（已请求取消时按钮被禁用，click() 不会重复触发）
+        if (QPushButton *cancelButton = dialog->findChild<QPushButton *>())
+        {
+            cancelButton->click();
+        }
+        event->ignore();
+        return true;
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::appendScannedMods()
+{
+    QList<ModItem> batch = scanProgress.takePending();
+    if (batch.isEmpty())
+    {
+        return;
+    }
+
+    // 只读访问用户数据（扫描线程在此期间不会修改它）
+    const UserDataManager *userData = modManager->getUserDataManager();
+    const QString lowerFilter = ui->unloadedSearchEdit->text().toLower();
+
+    ui->unloadedModsList->setUpdatesEnabled(false);
+    for (ModItem &mod : batch)
+    {
+        if (streamedModIds.contains(mod.packageId))
+        {
+            continue;
+        }
+        streamedModIds.insert(mod.packageId);
+
+        QString type = userData->getModType(mod.packageId);
+        if (!type.isEmpty())
+        {
+            mod.type = type;
+        }
+        mod.remark = userData->getModRemark(mod.packageId);
+
+        QListWidgetItem *item = createModListItem(&mod);
+        ui->unloadedModsList->addItem(item);
+        if (!lowerFilter.isEmpty())
+        {
+            // 与 filterUnloadedList 的匹配规则一致
+            item->setHidden(!(mod.name.toLower().contains(lowerFilter) ||
+                              mod.packageId.contains(lowerFilter) ||
+                              mod.remark.toLower().contains(lowerFilter) ||
+                              mod.type.toLower().contains(lowerFilter)));
+        }
+    }
+    ui->unloadedModsList->setUpdatesEnabled(true);
+}
+
 void MainWindow::loadGameConfig()
 {
     if (!configManager->loadConfig())
     {
         showStatusMessage("无法加载游戏配置");
+        return;
+    }
+
+    applyGameVersion();
+}
+
+void MainWindow::applyGameVersion()
+{
+    // 依赖和加载顺序约束按配置中的游戏版本选择，配置未记录版本时保持当前目标版本
+    const QString version = configManager->getVersion();
+    if (!version.isEmpty())
+    {
+        modManager->setGameVersion(version);
     }
 }
 
@@ -171,8 +341,8 @@ void MainWindow::updateModLists()
 void MainWindow::updateUnloadedList()
 {
     ui->unloadedModsList->clear();
+    listValidator->validate(); // 数据变化后才会重新校验
 
-    QStringList loadedMods = configManager->getActiveMods();
     QList<ModItem *> allMods = modManager->getAllMods();
 
     for (ModItem *mod : allMods)
@@ -188,8 +358,10 @@ void MainWindow::updateUnloadedList()
 void MainWindow::updateLoadedList()
 {
     ui->loadedModsList->clear();
+    loadedItems.clear();
+    listValidator->validate(); // 数据变化后才会重新校验
 
-    QStringList activeMods = configManager->getActiveMods();
+    const QStringList &activeMods = configManager->getActiveMods();
 
     for (const QString &packageId : activeMods)
     {
@@ -198,6 +370,7 @@ void MainWindow::updateLoadedList()
         {
             QListWidgetItem *item = createLoadedModListItem(mod);
             ui->loadedModsList->addItem(item);
+            loadedItems.insert(mod->modId, item);
         }
     }
 }
@@ -233,211 +406,114 @@ QListWidgetItem *MainWindow::createLoadedModListItem(ModItem *mod)
     item->setText(QString("%1\n[%2]").arg(displayText, typeText));
     item->setData(Qt::UserRole, mod->packageId);
 
-    // 检查依赖和加载顺序
-    QStringList missingDeps;
-    QStringList orderIssues;
-    bool depsOk = checkModDependencies(mod, missingDeps);
-    bool orderOk = checkModLoadOrder(mod, orderIssues);
-
-    if (!depsOk)
-    {
-        // 依赖未满足，标红并添加提示
-        item->setForeground(QColor(220, 20, 60)); // 深红色
-        QString tooltip = QString("依赖未满足:\n%1").arg(missingDeps.join("\n"));
-
-        // 如果加载顺序也有问题，一并显示
-        if (!orderOk)
-        {
-            tooltip += QString("\n\n加载顺序错误:\n%1").arg(orderIssues.join("\n"));
-        }
-
-        item->setToolTip(tooltip);
-    }
-    else if (!orderOk)
-    {
-        // 依赖满足但加载顺序错误，标黄并添加提示
-        item->setForeground(QColor(218, 165, 32)); // 金黄色
-        QString tooltip = QString("加载顺序错误:\n%1").arg(orderIssues.join("\n"));
-        item->setToolTip(tooltip);
-    }
-    else
-    {
-        // 依赖和顺序都满足，根据类型设置颜色
-        if (mod->isOfficialDLC)
-        {
-            item->setForeground(QColor(0, 120, 215)); // 蓝色
-        }
-        else if (mod->packageId.toLower() == "ludeon.rimworld")
-        {
-            item->setForeground(QColor(0, 150, 0)); // 绿色 - Core
-        }
-    }
-
+    applyLoadedItemStatus(item, mod);
     return item;
 }
 
-bool MainWindow::checkModDependencies(ModItem *mod, QStringList &missingDeps)
+void MainWindow::applyLoadedItemStatus(QListWidgetItem *item, ModItem *mod)
 {
-    missingDeps.clear();
-
-    if (!mod)
+    // 校验结果由 listValidator 缓存，激活列表变化时增量更新
+    const ActiveOrderIndex::ModStatus &status = activeOrder().statusOf(mod->modId);
+    const QStringList &missingDeps = status.missingDependencies;
+    const QStringList &orderIssues = status.orderIssues;
+    const QStringList &incompatibilities = status.incompatibilities;
+    const bool depsOk = missingDeps.isEmpty();
+    const bool conflictsOk = incompatibilities.isEmpty();
+    const bool orderOk = orderIssues.isEmpty();
+
+    // 提示中列出所有问题，颜色按 依赖 > 冲突 > 顺序 的严重程度选择
+    QStringList sections;
+    if (!depsOk)
     {
-        return true;
+        sections.append(QString("依赖未满足:\n%1").arg(missingDeps.join("\n")));
     }
-
-    // 获取当前已加载的mod列表
-    QStringList activeMods = configManager->getActiveMods();
-    QSet<QString> activeModsSet;
-    for (const QString &id : activeMods)
+    if (!conflictsOk)
     {
-        activeModsSet.insert(id.toLower());
+        sections.append(QString("不兼容:\n%1").arg(incompatibilities.join("\n")));
     }
-
-    // 检查dependencies（必须依赖）
-    for (const QString &depId : mod->dependencies)
-    {
-        if (!activeModsSet.contains(depId.toLower()))
-        {
-            missingDeps.append(QString("[依赖] %1").arg(depId));
-        }
-    }
-
-    // 检查forceLoadAfter（强制前置）
-    for (const QString &depId : mod->forceLoadAfter)
+    if (!orderOk)
     {
-        if (!activeModsSet.contains(depId.toLower()))
-        {
-            missingDeps.append(QString("[强制前置] %1").arg(depId));
-        }
+        sections.append(QString("加载顺序错误:\n%1").arg(orderIssues.join("\n")));
     }
 
-    return missingDeps.isEmpty();
-}
-
-bool MainWindow::checkModLoadOrder(ModItem *mod, QStringList &orderIssues)
-{
-    orderIssues.clear();
-
-    if (!mod)
+    if (!depsOk)
     {
-        return true;
+        // 依赖未满足，标红
+        item->setForeground(QColor(220, 20, 60)); // 深红色
+        item->setToolTip(sections.join("\n\n"));
     }
-
-    // 获取当前已加载的mod列表
-    QStringList activeMods = configManager->getActiveMods();
-
-    // 建立 packageId 到索引的映射
-    QMap<QString, int> modIndexMap;
-    for (int i = 0; i < activeMods.size(); ++i)
+    else if (!conflictsOk)
     {
-        modIndexMap[activeMods[i].toLower()] = i;
+        // 与其他已加载的Mod不兼容，标紫
+        item->setForeground(QColor(148, 0, 211)); // 深紫色
+        item->setToolTip(sections.join("\n\n"));
     }
-
-    // 获取当前mod的索引
-    int currentIndex = modIndexMap.value(mod->packageId.toLower(), -1);
-    if (currentIndex == -1)
+    else if (!orderOk)
     {
-        return true; // mod不在列表中
+        // 依赖满足但加载顺序错误，标黄
+        item->setForeground(QColor(218, 165, 32)); // 金黄色
+        item->setToolTip(sections.join("\n\n"));
     }
-
-    // 检查loadAfter（应该在这些mod之后加载）
-    for (const QString &afterId : mod->loadAfter)
+    else
     {
-        int afterIndex = modIndexMap.value(afterId.toLower(), -1);
-        if (afterIndex != -1 && currentIndex < afterIndex)
+        // 依赖和顺序都满足，根据类型设置颜色
+        item->setToolTip(QString());
+        if (mod->isOfficialDLC)
         {
-            orderIssues.append(QString("应在 %1 之后加载").arg(afterId));
+            item->setForeground(QColor(0, 120, 215)); // 蓝色
         }
-    }
-
-    // 检查forceLoadAfter（强制在这些mod之后加载）
-    for (const QString &afterId : mod->forceLoadAfter)
-    {
-        int afterIndex = modIndexMap.value(afterId.toLower(), -1);
-        if (afterIndex != -1 && currentIndex < afterIndex)
+        else if (mod->packageId.toLower() == "ludeon.rimworld")
         {
-            orderIssues.append(QString("必须在 %1 之后加载").arg(afterId));
+            item->setForeground(QColor(0, 150, 0)); // 绿色 - Core
         }
-    }
-
-    // 检查loadBefore（应该在这些mod之前加载）
-    for (const QString &beforeId : mod->loadBefore)
-    {
-        int beforeIndex = modIndexMap.value(beforeId.toLower(), -1);
-        if (beforeIndex != -1 && currentIndex > beforeIndex)
+        else
         {
-            orderIssues.append(QString("应在 %1 之前加载").arg(beforeId));
+            item->setData(Qt::ForegroundRole, QVariant());
         }
     }
+}
 
-    // 检查forceLoadBefore（强制在这些mod之前加载）
-    for (const QString &beforeId : mod->forceLoadBefore)
+void MainWindow::refreshLoadedItems(const QList<quint32> &modIds)
+{
+    // 只更新校验结果变化的条目
+    for (quint32 id : modIds)
     {
-        int beforeIndex = modIndexMap.value(beforeId.toLower(), -1);
-        if (beforeIndex != -1 && currentIndex > beforeIndex)
+        QListWidgetItem *item = loadedItems.value(id, nullptr);
+        ModItem *mod = modManager->findModById(id);
+        if (item && mod)
         {
-            orderIssues.append(QString("必须在 %1 之前加载").arg(beforeId));
+            applyLoadedItemStatus(item, mod);
         }
     }
-
-    return orderIssues.isEmpty();
 }
 
 QStringList MainWindow::checkDependentMods(const QString &packageId)
 {
     QStringList dependents;
-    QStringList activeMods = configManager->getActiveMods();
 
-    for (const QString &activeId : activeMods)
+    const quint32 targetId = modManager->findModId(packageId);
+    if (targetId == INVALID_MOD_ID)
     {
-        ModItem *mod = getModByPackageId(activeId);
-        if (!mod || activeId.compare(packageId, Qt::CaseInsensitive) == 0)
-        {
-            continue;
-        }
-
-        // 检查是否依赖于要移除的mod
-        bool isDependant = false;
-
-        // 检查dependencies
-        for (const QString &dep : mod->dependencies)
-        {
-            if (dep.compare(packageId, Qt::CaseInsensitive) == 0)
-            {
-                dependents.append(QString("%1 [依赖]").arg(getModDisplayText(mod)));
-                isDependant = true;
-                break;
-            }
-        }
-
-        if (isDependant)
-            continue;
-
-        // 检查forceLoadAfter
-        for (const QString &dep : mod->forceLoadAfter)
-        {
-            if (dep.compare(packageId, Qt::CaseInsensitive) == 0)
-            {
-                dependents.append(QString("%1 [强制前置]").arg(getModDisplayText(mod)));
-                isDependant = true;
-                break;
-            }
-        }
-
-        if (isDependant)
-            continue;
+        return dependents; // 没有任何Mod引用该PackageId
+    }
 
-        // 检查loadAfter
-        for (const QString &dep : mod->loadAfter)
+    // 反向依赖索引按依赖强度依次查询，每个mod只报告最强的一种关系，结果按加载顺序排列
+    const ActiveOrderIndex &order = activeOrder();
+    QMap<int, QString> byPosition;
+    for (ModDependentKind kind : MOD_DEPENDENT_KINDS)
+    {
+        for (quint32 id : modManager->getDependentIds(targetId, kind))
         {
-            if (dep.compare(packageId, Qt::CaseInsensitive) == 0)
+            const int position = order.positionOf(id);
+            if (position >= 0 && !byPosition.contains(position))
             {
-                dependents.append(QString("%1 [建议前置]").arg(getModDisplayText(mod)));
-                break;
+                byPosition.insert(position, QString("%1 [%2]").arg(getModDisplayText(modManager->findModById(id)),
+                                                                   modDependentKindLabel(kind)));
             }
         }
     }
 
+    dependents = byPosition.values();
     return dependents;
 }
 
@@ -454,17 +530,40 @@ QString MainWindow::getModDisplayText(ModItem *mod)
     return mod->packageId;
 }
 
-bool MainWindow::isModLoaded(const QString &packageId)
+const ActiveOrderIndex &MainWindow::activeOrder()
+{
+    // 激活列表或Mod数据变化后才会重新校验，单次编辑通过 listValidator 增量更新
+    return listValidator->validate();
+}
+
+bool MainWindow::moveActiveMod(int fromRow, int toRow)
 {
-    QStringList activeMods = configManager->getActiveMods();
-    for (const QString &activeId : activeMods)
+    // 已加载列表只显示已安装的Mod，按行找到激活列表中的实际位置
+    QListWidgetItem *movedItem = ui->loadedModsList->item(fromRow);
+    QListWidgetItem *anchorItem = ui->loadedModsList->item(toRow);
+    if (!movedItem || !anchorItem || fromRow == toRow)
     {
-        if (activeId.compare(packageId, Qt::CaseInsensitive) == 0)
-        {
-            return true;
-        }
+        return false;
+    }
+
+    const QString packageId = movedItem->data(Qt::UserRole).toString();
+    const int to = activeOrder().positionOf(anchorItem->data(Qt::UserRole).toString());
+    QList<quint32> changed;
+    if (to < 0 || !listValidator->moveMod(packageId, to, &changed))
+    {
+        return false;
     }
-    return false;
+
+    // 列表条目原地移动，只刷新校验结果变化的条目
+    ui->loadedModsList->takeItem(fromRow);
+    ui->loadedModsList->insertItem(toRow, movedItem);
+    refreshLoadedItems(changed);
+    return true;
+}
+
+bool MainWindow::isModLoaded(const QString &packageId)
+{
+    return activeOrder().positionOf(packageId) >= 0;
 }
 
 ModItem *MainWindow::getModByPackageId(const QString &packageId)
@@ -474,16 +573,21 @@ ModItem *MainWindow::getModByPackageId(const QString &packageId)
 
 void MainWindow::onSaveToGame()
 {
-    if (configManager->saveConfig())
-    {
-        QMessageBox::information(this, "保存成功", "已成功保存到游戏配置文件");
-        showStatusMessage("已保存到游戏配置");
-    }
-    else
-    {
-        QMessageBox::warning(this, "保存失败", "无法保存到游戏配置文件");
-        showStatusMessage("保存失败");
-    }
+    // 在工作线程中写入，写完后再提示结果
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher]()
+            {
+        if (watcher->result()) {
+            QMessageBox::information(this, "保存成功", "已成功保存到游戏配置文件");
+            showStatusMessage("已保存到游戏配置");
+        } else {
+            QMessageBox::warning(this, "保存失败", "无法保存到游戏配置文件");
+            showStatusMessage("保存失败");
+        }
+        watcher->deleteLater(); });
+
+    showStatusMessage("正在保存...");
+    watcher->setFuture(configManager->saveConfigAsync());
 }
 
 void MainWindow::onSaveAs()
@@ -497,7 +601,7 @@ void MainWindow::onSaveAs()
     if (!filePath.isEmpty())
     {
         UserDataManager *userMgr = modManager->getUserDataManager();
-        QStringList activeMods = configManager->getActiveMods();
+        const QStringList &activeMods = configManager->getActiveMods();
         QStringList knownExpansions = configManager->getKnownExpansions();
         QString version = configManager->getVersion();
 
@@ -531,6 +635,7 @@ void MainWindow::loadConfigFromFile(const QString &filePath)
 {
     if (configManager->loadConfig(filePath))
     {
+        applyGameVersion();
         updateModLists();
         showStatusMessage("配置已加载");
     }
@@ -607,7 +712,7 @@ void MainWindow::onTypePriority()
 void MainWindow::onAutoSort()
 {
     // 获取当前已加载的 Mod 列表
-    QStringList activeMods = configManager->getActiveMods();
+    const QStringList &activeMods = configManager->getActiveMods();
     if (activeMods.isEmpty())
     {
         QMessageBox::information(this, "排序", "当前没有已加载的 Mod");
@@ -631,23 +736,67 @@ void MainWindow::onAutoSort()
         return;
     }
 
-    // 检查循环依赖
-    if (ModSorter::hasCircularDependency(modsToSort))
-    {
-        QStringList circular = ModSorter::getCircularDependencies(modsToSort);
-        QString circularInfo = circular.join("\n");
+    // 排序前的问题数（校验结果已缓存，不会重新遍历）
+    const int issuesBefore = activeOrder().issueCount();
 
-        QMessageBox::warning(this, "检测到循环依赖",
-                             QString("以下 Mod 存在循环依赖，可能无法完全排序：\n\n%1\n\n"
-                                     "请检查 Mod 的依赖设置。")
-                                 .arg(circularInfo));
-    }
+    // 依赖图只构建一次，循环检查和排序共用
+    const ModDependencyGraph graph(modsToSort);
 
     // 获取类型优先级
     QStringList typePriority = modManager->getUserDataManager()->getTypePriority();
 
-    // 执行排序
-    QList<ModItem *> sorted = ModSorter::sortMods(modsToSort, typePriority);
+    // 执行排序（有循环时放弃尽量少的 loadBefore/loadAfter 建议）
+    QStringList droppedHints;
+    QList<bool> cycleResolved;
+    QList<ModItem *> sorted = ModSorter::sortMods(graph, typePriority, &droppedHints, &cycleResolved);
+
+    // 报告循环依赖（构建依赖图时已经找出所有循环），按是否已通过放弃建议解决分别列出
+    if (ModSorter::hasCircularDependency(graph))
+    {
+        QStringList resolvedInfo;
+        QStringList unresolvedInfo;
+        const QList<QStringList> cycles = ModSorter::describeCycles(graph);
+        for (int i = 0; i < cycles.size(); ++i)
+        {
+            const QString info = QString("循环 %1：\n  %2").arg(i + 1).arg(cycles[i].join("\n  "));
+            if (cycleResolved.value(i, false))
+            {
+                resolvedInfo.append(info);
+            }
+            else
+            {
+                unresolvedInfo.append(info);
+            }
+        }
+
+        QStringList sections;
+        if (!unresolvedInfo.isEmpty())
+        {
+            sections.append(QString("以下约束构成循环，无法同时满足：\n\n%1\n\n"
+                                    "这些循环只能通过修改依赖或强制约束打破，其中的 Mod 及依赖它们的 Mod 将排在末尾。"
+                                    "移除其中任意一条约束即可打破该循环（同一组 Mod 之间可能还有其他循环，修改后请重新排序）。")
+                                .arg(unresolvedInfo.join("\n\n")));
+        }
+        if (!resolvedInfo.isEmpty())
+        {
+            sections.append(QString("以下循环已通过忽略加载顺序建议解决：\n\n%1").arg(resolvedInfo.join("\n\n")));
+        }
+        if (!droppedHints.isEmpty())
+        {
+            sections.append(QString("排序时忽略了以下 %1 条加载顺序建议：\n  %2")
+                                .arg(droppedHints.size())
+                                .arg(droppedHints.join("\n  ")));
+        }
+
+        if (unresolvedInfo.isEmpty())
+        {
+            QMessageBox::information(this, "循环依赖已解决", sections.join("\n\n"));
+        }
+        else
+        {
+            QMessageBox::warning(this, "检测到循环依赖", sections.join("\n\n"));
+        }
+    }
 
     // 更新 configManager
     QStringList sortedIds;
@@ -657,15 +806,36 @@ void MainWindow::onAutoSort()
     }
     configManager->setActiveMods(sortedIds);
 
-    // 更新 UI
+    // 更新 UI（激活列表已整体替换，这里会完整校验一次）
     updateLoadedList();
+    const ActiveOrderIndex &order = activeOrder();
+    const int issuesAfter = order.issueCount();
+
+    // 排序无法解决不兼容，单独列出
+    QStringList conflictInfo;
+    for (const auto &[first, second] : order.conflictPairs())
+    {
+        conflictInfo.append(QString("%1  ×  %2")
+                                .arg(modManager->getPackageIdById(first), modManager->getPackageIdById(second)));
+    }
 
     showStatusMessage(QString("排序完成，共 %1 个 Mod").arg(sorted.size()));
 
     QMessageBox::information(this, "排序完成",
-                             QString("已按照依赖关系和类型优先级重新排序 %1 个 Mod。\n\n"
+                             QString("已按照依赖关系和类型优先级重新排序 %1 个 Mod。\n"
+                                     "存在问题的 Mod：排序前 %2 个，排序后 %3 个。\n\n"
                                      "请检查排序结果是否符合预期。")
-                                 .arg(sorted.size()));
+                                 .arg(sorted.size())
+                                 .arg(issuesBefore)
+                                 .arg(issuesAfter));
+
+    if (!conflictInfo.isEmpty())
+    {
+        QMessageBox::warning(this, "检测到不兼容的 Mod",
+                             QString("以下 %1 对已加载的 Mod 互不兼容，排序无法解决，请移除其中之一：\n\n  %2")
+                                 .arg(conflictInfo.size())
+                                 .arg(conflictInfo.join("\n  ")));
+    }
 }
 
 void MainWindow::onAbout()
@@ -687,14 +857,124 @@ void MainWindow::onAddSelected()
         return;
     }
 
+    QList<quint32> requested;
+    QHash<quint32, QListWidgetItem *> selectedById;
     for (QListWidgetItem *item : selectedItems)
     {
         QString packageId = item->data(Qt::UserRole).toString();
-        configManager->addMod(packageId);
+        ModItem *mod = getModByPackageId(packageId);
+        if (!mod || isModLoaded(packageId) || selectedById.contains(mod->modId))
+        {
+            continue;
+        }
+        requested.append(mod->modId);
+        selectedById.insert(mod->modId, item);
     }
 
-    updateModLists();
-    showStatusMessage(QString("已添加 %1 个 Mod").arg(selectedItems.count()));
+    // 依赖闭包中尚未加载的Mod可以一次性加入
+    const DependencyPlan plan = dependencyResolver->plan(requested, activeOrder());
+    bool withDependencies = false;
+    if (plan.hasDependencies() || !plan.missing.isEmpty())
+    {
+        QStringList names;
+        for (quint32 id : plan.dependencies)
+        {
+            names.append(getModDisplayText(modManager->findModById(id)));
+        }
+
+        QString message;
+        if (plan.hasDependencies())
+        {
+            message = QString("所选 Mod 还需要以下 %1 个未加载的 Mod：\n\n%2\n\n是否一并添加？")
+                          .arg(names.size())
+                          .arg(names.join("\n"));
+        }
+        if (!plan.missing.isEmpty())
+        {
+            if (!message.isEmpty())
+            {
+                message += "\n\n";
+            }
+            message += QString("以下依赖未安装，需要另行订阅：\n%1").arg(plan.missing.join("\n"));
+        }
+
+        if (plan.hasDependencies())
+        {
+            QMessageBox::StandardButton reply = QMessageBox::question(
+                this, "添加依赖", message, QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+            if (reply == QMessageBox::Cancel)
+            {
+                return;
+            }
+            withDependencies = reply == QMessageBox::Yes;
+        }
+        else
+        {
+            QMessageBox::information(this, "缺少依赖", message);
+        }
+    }
+
+    // 按依赖在前的顺序加入：依赖插入到其前置Mod之后，选中的Mod追加到末尾
+    const QSet<quint32> dependencySet(plan.dependencies.cbegin(), plan.dependencies.cend());
+    int officialEnd = DependencyResolver::officialBlockEnd(activeOrder());
+    QList<quint32> changed;
+    int addedCount = 0;
+    for (quint32 id : plan.order)
+    {
+        const bool isDependency = dependencySet.contains(id);
+        if (isDependency && !withDependencies)
+        {
+            continue;
+        }
+
+        ModItem *mod = modManager->findModById(id);
+        QList<quint32> modChanged;
+        const int position = isDependency ? dependencyResolver->insertPosition(id, activeOrder(), officialEnd) : -1;
+        const bool added = isDependency ? listValidator->insertMod(mod->packageId, position, &modChanged)
+                                        : listValidator->addMod(mod->packageId, &modChanged);
+        if (!added)
+        {
+            continue;
+        }
+        ++addedCount;
+
+        // 新加入的Mod都不早于官方内容块末尾，块内位置不变；加入的是官方内容时块随之延长
+        if (mod->source == ModSource::Official)
+        {
+            officialEnd = qMax(officialEnd, activeOrder().positionOf(id) + 1);
+        }
+
+        for (quint32 changedId : modChanged)
+        {
+            if (!changed.contains(changedId))
+            {
+                changed.append(changedId);
+            }
+        }
+
+        // 只追加到末尾时条目直接在两个列表之间移动
+        if (!withDependencies)
+        {
+            QListWidgetItem *item = selectedById.value(id);
+            delete ui->unloadedModsList->takeItem(ui->unloadedModsList->row(item));
+            QListWidgetItem *loadedItem = createLoadedModListItem(mod);
+            ui->loadedModsList->addItem(loadedItem);
+            loadedItems.insert(mod->modId, loadedItem);
+        }
+    }
+
+    if (withDependencies)
+    {
+        // 依赖插入到了列表中间，整体刷新（校验结果已增量更新，不会重新校验）
+        updateModLists();
+        filterUnloadedList(ui->unloadedSearchEdit->text());
+    }
+    else
+    {
+        refreshLoadedItems(changed);
+    }
+    filterLoadedList(ui->loadedSearchEdit->text());
+    showStatusMessage(QString("已添加 %1 个 Mod").arg(addedCount));
 }
 
 void MainWindow::onRemoveMod()
@@ -734,8 +1014,25 @@ void MainWindow::onRemoveMod()
         }
     }
 
-    configManager->removeMod(packageId);
-    updateModLists();
+    // 条目移回未加载列表，只刷新引用了该Mod的条目
+    QList<quint32> changed;
+    if (!listValidator->removeMod(packageId, &changed))
+    {
+        updateModLists();
+        showStatusMessage("Mod 已移除");
+        return;
+    }
+
+    ModItem *mod = getModByPackageId(packageId);
+    if (mod)
+    {
+        loadedItems.remove(mod->modId);
+        ui->unloadedModsList->addItem(createModListItem(mod));
+        filterUnloadedList(ui->unloadedSearchEdit->text());
+    }
+    delete ui->loadedModsList->takeItem(ui->loadedModsList->row(currentItem));
+    refreshLoadedItems(changed);
+
     showStatusMessage("Mod 已移除");
 }
 
@@ -747,12 +1044,8 @@ void MainWindow::onMoveUp()
         return;
     }
 
-    QListWidgetItem *currentItem = ui->loadedModsList->currentItem();
-    QString packageId = currentItem->data(Qt::UserRole).toString();
-
-    if (configManager->moveModUp(packageId))
+    if (moveActiveMod(currentRow, currentRow - 1))
     {
-        updateLoadedList();
         ui->loadedModsList->setCurrentRow(currentRow - 1);
         showStatusMessage("已上移");
     }
@@ -766,12 +1059,8 @@ void MainWindow::onMoveDown()
         return;
     }
 
-    QListWidgetItem *currentItem = ui->loadedModsList->currentItem();
-    QString packageId = currentItem->data(Qt::UserRole).toString();
-
-    if (configManager->moveModDown(packageId))
+    if (moveActiveMod(currentRow, currentRow + 1))
     {
-        updateLoadedList();
         ui->loadedModsList->setCurrentRow(currentRow + 1);
         showStatusMessage("已下移");
     }
@@ -877,8 +1166,8 @@ void MainWindow::filterLoadedList(const QString &filter)
 
 void MainWindow::onModDetailChanged()
 {
-    // 保存修改
-    modManager->saveModsToUserData();
+    // 只把当前Mod的修改追加到日志，数据文件由日志在后台压缩
+    modManager->saveModUserData(currentSelectedMod);
 
     // 更新列表显示
     updateModLists();
@@ -886,9 +1175,39 @@ void MainWindow::onModDetailChanged()
     showStatusMessage("Mod 详情已更新");
 }
 
-void MainWindow::onLoadedListOrderChanged()
+void MainWindow::onLoadedListOrderChanged(const QModelIndex &, int start, int end, const QModelIndex &, int row)
 {
-    // 用户通过拖拽改变了顺序，需要更新 configManager
+    // 拖拽单个条目：列表已经完成移动，按新位置前后的条目换算激活列表中的目标位置
+    const int newRow = row > start ? row - 1 : row;
+    QListWidgetItem *movedItem = ui->loadedModsList->item(newRow);
+    if (start == end && movedItem)
+    {
+        const QString packageId = movedItem->data(Qt::UserRole).toString();
+        const ActiveOrderIndex &order = activeOrder();
+        const int from = order.positionOf(packageId);
+
+        int to = -1;
+        if (QListWidgetItem *previous = ui->loadedModsList->item(newRow - 1))
+        {
+            const int previousPos = order.positionOf(previous->data(Qt::UserRole).toString());
+            to = previousPos < from ? previousPos + 1 : previousPos;
+        }
+        else if (QListWidgetItem *next = ui->loadedModsList->item(newRow + 1))
+        {
+            const int nextPos = order.positionOf(next->data(Qt::UserRole).toString());
+            to = nextPos < from ? nextPos : nextPos - 1;
+        }
+
+        QList<quint32> changed;
+        if (from >= 0 && to >= 0 && listValidator->moveMod(packageId, to, &changed))
+        {
+            refreshLoadedItems(changed);
+            showStatusMessage("加载顺序已更新");
+            return;
+        }
+    }
+
+    // 多个条目同时移动时按列表顺序整体替换
     QStringList newOrder;
 
     for (int i = 0; i < ui->loadedModsList->count(); ++i)
@@ -906,6 +1225,35 @@ void MainWindow::onLoadedListOrderChanged()
     showStatusMessage("加载顺序已更新");
 }
 
+void MainWindow::onModDirectoriesChanged(const QStringList &modDirPaths)
+{
+    // 只重新解析变化的Mod，其余ModItem保持不变
+    ModRescanSummary summary = modManager->rescanModDirectories(modDirPaths);
+    if (summary.isEmpty())
+    {
+        return;
+    }
+
+    // 当前选中的Mod已被删除时清空详情面板（只比较指针，不解引用已释放的对象）
+    if (currentSelectedMod && !modManager->getAllMods().contains(currentSelectedMod))
+    {
+        currentSelectedMod = nullptr;
+        detailPanel->setModItem(nullptr, modManager);
+    }
+    else if (currentSelectedMod && summary.updated.contains(currentSelectedMod->packageId))
+    {
+        detailPanel->setModItem(currentSelectedMod, modManager);
+    }
+
+    updateModLists();
+
+    showStatusMessage(QString("检测到 %1 个 Mod 变化，已增量更新（新增 %2，更新 %3，移除 %4）")
+                          .arg(summary.count())
+                          .arg(summary.added.size())
+                          .arg(summary.updated.size())
+                          .arg(summary.removed.size()));
+}
+
 void MainWindow::showStatusMessage(const QString &message, int timeout)
 {
     ui->statusbar->showMessage(message, timeout);
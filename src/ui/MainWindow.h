@@ -1,12 +1,19 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "../data/DependencyResolver.h"
 #include "../data/ModConfigManager.h"
+#include "../data/ModDirectoryWatcher.h"
+#include "../data/ModListValidator.h"
 #include "../data/ModManager.h"
 #include "../data/PathConfig.h"
+#include "../data/ScanProgress.h"
 #include "../data/UserDataManager.h"
+#include <QHash>
 #include <QListWidgetItem>
 #include <QMainWindow>
+#include <QModelIndex>
+#include <QSet>
 
 QT_BEGIN_NAMESPACE
 namespace Ui
@@ -25,6 +32,10 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    // 扫描进度对话框：Esc 和关闭窗口改为请求取消，对话框保持显示直到扫描结束
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 public slots:
     void startScan();
 
@@ -58,14 +69,23 @@ private slots:
     void onModDetailChanged();
 
     // 拖拽排序完成
-    void onLoadedListOrderChanged();
+    void onLoadedListOrderChanged(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row);
+
+    // Mod目录变化（增量重扫）
+    void onModDirectoriesChanged(const QStringList &modDirPaths);
 
 private:
     Ui::MainWindow *ui;
     ModManager *modManager;
     ModConfigManager *configManager;
+    ModListValidator *listValidator; // 激活列表的位置和校验结果（按修改代数缓存，单次编辑增量更新）
+    DependencyResolver *dependencyResolver; // 添加Mod时计算需要一并加入的依赖
     ModDetailPanel *detailPanel;
+    ModDirectoryWatcher *modWatcher;
     PathConfig pathConfig;
+    ScanProgress scanProgress;     // 扫描进度（扫描线程写入，界面定时轮询）
+    QSet<QString> streamedModIds;  // 扫描过程中已追加到未加载列表的Mod（含已激活的Mod）
+    QHash<quint32, QListWidgetItem *> loadedItems; // Mod整数ID到已加载列表中的条目
 
     ModItem *currentSelectedMod;
 
@@ -73,10 +93,12 @@ private:
     void setupConnections();
     void initializeManagers();
     void loadGameConfig();
+    void applyGameVersion();
 
     // UI更新
     void updateModLists();
     void updateUnloadedList();
+    void appendScannedMods();
     void updateLoadedList();
     void filterUnloadedList(const QString &filter);
     void filterLoadedList(const QString &filter);
@@ -84,15 +106,17 @@ private:
     // 列表项创建
     QListWidgetItem *createModListItem(ModItem *mod);
     QListWidgetItem *createLoadedModListItem(ModItem *mod);
+    void applyLoadedItemStatus(QListWidgetItem *item, ModItem *mod);
+    void refreshLoadedItems(const QList<quint32> &modIds);
     QString getModDisplayText(ModItem *mod);
 
     // 依赖检查
-    bool checkModDependencies(ModItem *mod, QStringList &missingDeps);
-    bool checkModLoadOrder(ModItem *mod, QStringList &orderIssues);
     QStringList checkDependentMods(const QString &packageId);
     void updateLoadedListWithDependencyCheck();
 
     // 状态查询
+    const ActiveOrderIndex &activeOrder();
+    bool moveActiveMod(int fromRow, int toRow);
     bool isModLoaded(const QString &packageId);
     ModItem *getModByPackageId(const QString &packageId);
 
@@ -1,5 +1,6 @@
 #include "ModDetailPanel.h"
 #include "ui_ModDetailPanel.h"
+#include <QSet>
 
 ModDetailPanel::ModDetailPanel(QWidget *parent)
     : QWidget(parent), ui(new Ui::ModDetailPanel), currentMod(nullptr), modManager(nullptr)
@@ -47,6 +48,7 @@ void ModDetailPanel::clearDisplay()
     ui->forceLoadBeforeList->clear();
     ui->forceLoadAfterList->clear();
     ui->incompatibleList->clear();
+    ui->requiredByList->clear();
 
     ui->saveButton->setEnabled(false);
 }
@@ -124,8 +126,9 @@ void ModDetailPanel::displayModInfo()
 
     ui->remarkTextEdit->setText(currentMod->remark);
 
-    // 描述
-    ui->descriptionBrowser->setPlainText(currentMod->description.isEmpty() ? "无描述" : currentMod->description);
+    // 描述（按需解压，ModManager缓存最近查看的描述）
+    const QString description = modManager ? modManager->getModDescription(currentMod) : currentMod->getDescription();
+    ui->descriptionBrowser->setPlainText(description.isEmpty() ? "无描述" : description);
 
     // 如果有URL，添加链接
     if (!currentMod->url.isEmpty())
@@ -235,6 +238,31 @@ void ModDetailPanel::displayDependencies()
         }
     }
     adjustListHeight(ui->incompatibleList);
+
+    // 被依赖（反向依赖索引，按依赖强度排列，每个Mod只显示最强的一种关系）
+    ui->requiredByList->clear();
+    if (modManager)
+    {
+        QSet<const ModItem *> listed;
+        for (ModDependentKind kind : MOD_DEPENDENT_KINDS)
+        {
+            for (ModItem *mod : modManager->getDependents(currentMod->packageId, kind))
+            {
+                if (listed.contains(mod))
+                {
+                    continue;
+                }
+                listed.insert(mod);
+                const QString name = mod->name.isEmpty() ? mod->packageId : mod->name;
+                ui->requiredByList->addItem(QString("%1 [%2]").arg(name, modDependentKindLabel(kind)));
+            }
+        }
+    }
+    if (ui->requiredByList->count() == 0)
+    {
+        ui->requiredByList->addItem("(无)");
+    }
+    adjustListHeight(ui->requiredByList);
 }
 
 void ModDetailPanel::onSaveClicked()